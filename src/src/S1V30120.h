@@ -13,18 +13,39 @@
 
 #include <inttypes.h>
 #include <string.h>
+#include <string_view>
 #include "S1V30120_const.h"
 #include "S1V30120_init_data.h"
+#include "isc_msg.h"
+#include "metrics.h"
+#include "isc_trace.h"
+#include "gpio_pins.h"
 #include <SPI.h>
+#include <esp32/rom/crc.h>
 #include <mutex>
+#include <atomic>
 
-class S1V30120
+/**
+ * @brief S1V30120 driver
+ *
+ * @tparam Trace - protocol trace policy, NoTrace or IscTrace<>, see isc_trace.h
+ * @tparam Pins - pin access policy, ArduinoPins or Esp32Pins, see gpio_pins.h
+ */
+template <class Trace = NoTrace, class Pins = DefaultPins>
+class S1V30120Driver
 {
 
 public:
 
-    static const uint16_t maximumMsgSize = 248;//121;
-    static const uint16_t maximumBufferSize = maximumMsgSize + 7;
+    static constexpr uint16_t maximumMsgSize = 248;//121;
+    static constexpr uint16_t maximumBufferSize = maximumMsgSize + 7;
+    static constexpr int16_t volumeMin = -48;   // [dB]
+    static constexpr int16_t volumeMax = 18;    // [dB]
+    using TracePolicy = Trace;
+
+    /// @brief steps of init()
+    enum class InitStep : uint8_t { reset, version, upload, run, test, fwVersion, audio, volume, tts };
+    using InitProgress = void (*)(InitStep step);
 
     /**
      * @brief Construct a new S1V30120 object
@@ -33,16 +54,20 @@ public:
      * @param resetPin  - reset pin - NRESET
      * @param rdyPin    - ready pin - GPIOA3
      * @param mutePin   - mute aplifier, e.g. LM386 - gain
+     * @param csPin     - chip select, -1 - SS pin of the SPI object. More chips may share one bus,
+     *                    each one with its own CS, RESET, RDY & MUTE.
      */
-    explicit S1V30120(SPIClass* spi, uint8_t resetPin, uint8_t rdyPin, uint8_t mutePin) : _spi(spi),
+    explicit S1V30120Driver(SPIClass* spi, uint8_t resetPin, uint8_t rdyPin, uint8_t mutePin, int8_t csPin = -1) : _spi(spi),
                                                                                          _resetPin(resetPin),
                                                                                          _rdyPin(rdyPin),
-                                                                                         _mutePin(mutePin)
+                                                                                         _mutePin(mutePin),
+                                                                                         _csPin(csPin < 0 ? spi->pinSS() : csPin)
     {
-        pinMode(_spi->pinSS(), OUTPUT); // CS
-        pinMode(_resetPin, OUTPUT);     // RESET
-        pinMode(_rdyPin, INPUT);        // RDY
-        pinMode(_mutePin, OUTPUT);      // MUTE
+        Pins::output(_csPin);           // CS
+        Pins::write(_csPin, HIGH);
+        Pins::output(_resetPin);        // RESET
+        Pins::input(_rdyPin);           // RDY
+        Pins::output(_mutePin);         // MUTE
     }
 
     
@@ -50,51 +75,67 @@ public:
      * @brief S1V30120 initialization and firmware upload. Repeated calls are possible.
      * 
      * @param epson  - true - Epson parse, false DECtalk
+     * @param progress - optional, called after every successful step, e.g. boot profiling
      * @return true if success 
      * @return false 
      */
-    bool init(bool epson = false)
+    bool init(bool epson = false, InitProgress progress = nullptr)
     {
         auto rc = false;
         std::lock_guard<std::mutex> lck(_mtx);
+        _ready = false;
+        _fault = false;
+        _inaction = false;
+        auto done = [progress](InitStep step) { if (progress) progress(step); };
         do
         {
             reset(); 
+            done(InitStep::reset);
 
             // verify IC availability and find out the HW version
             if (!version()) 
                 break;
+            done(InitStep::version);
 
             // upload firmware
             if (!uploadFW())
                 break;
+            done(InitStep::upload);
 
             // run firmware
             if (!run()) 
                 break;   
+            done(InitStep::run);
 
             // registration 
             if (!test()) 
                 break;   
+            done(InitStep::test);
 
             // check FW version
             if (!version()) 
                 break;  
+            done(InitStep::fwVersion);
 
             // audio configuration
             if (!audioCfg()) 
                 break; 
+            done(InitStep::audio);
 
             // maximum volume
             if (! maxVolume()) 
                 break; 
+            done(InitStep::volume);
  
             // TTS
             if (! setupTTS(epson)) 
                 break; 
+            done(InitStep::tts);
 
             rc = true;
         } while (false);
+        _ready = rc;
+        if (!rc) _fault = true;
         return rc;
     }
 
@@ -112,48 +153,103 @@ public:
      */
 
     /// @brief plays a text message with a maximum length of maximumMsgSize characters
-    /// @param text the text of the message
+    /// @param text the text of the message, not copied except into the transmit frame
     /// @param mute  true - muted
     /// @param flush true =  this TTS output is flushed and the current string is spoken immediately
     ///              false= this string is spoken after any previous speak requests have been finished
     /// @return true / false
-    bool speak(const String &text, bool mute = false, bool flush = true)
+    bool speak(std::string_view text, bool mute = false, bool flush = true)
+    {
+        return speak(text.data(), text.size(), mute, flush);
+    }
+
+    /// @brief plays a text message with a maximum length of maximumMsgSize characters
+    /// @param text the text of the message, need not be zero terminated
+    /// @param sz text length
+    /// @param mute  true - muted
+    /// @param flush see above
+    /// @return true / false
+    bool speak(const char *text, size_t sz, bool mute = false, bool flush = true)
     {
         std::lock_guard<std::mutex> lck(_mtx);
         
-        if (text.isEmpty()) return true;
+        if (sz == 0) return true;
+        if (_fault) return false;
+        auto start = micros();
 
         _inaction = true;
         
-        digitalWrite(_mutePin, mute);
+        Pins::write(_mutePin, mute);
         
-        memset(_buffer,0,sizeof(_buffer));
-        auto sz = text.length();
+        // tts_flush_enable, text, zero terminator
         if (sz > maximumMsgSize) sz = maximumMsgSize;
-        auto len = sz + 6;
-        _buffer[0] = len & 0xFF;          
-        _buffer[1] = (len & 0xFF00) >> 8; 
-        _buffer[2] = ISC_TTS_SPEAK_REQ & 0xFF;
-        _buffer[3] = (ISC_TTS_SPEAK_REQ & 0xFF00) >> 8;
-        _buffer[4] = flush ? 0x01 : 0x00; 
-
-        for (auto i = 0; i < sz; i++)
-        {
-            _buffer[i+5] = text[i];
-        }
+        auto len = Isc::header(_buffer, ISC_TTS_SPEAK_REQ, sz + 2);
+        _buffer[Isc::headerSize] = flush ? 0x01 : 0x00;
+        memcpy(&_buffer[Isc::headerSize + 1], text, sz);
+        _buffer[Isc::headerSize + 1 + sz] = 0;
 
-        sendMsg((uint8_t*) _buffer, len);
-        return checkResponse(ISC_TTS_SPEAK_RESP, 0x0000, 16);
+        auto rc = sendMsg(_buffer, len) && checkResponse(ISC_TTS_SPEAK_RESP, 0x0000, 16);
+        metrics().speakLatency.observe(micros() - start);
+        return rc;
     }
 
-    /// @brief is already speak finished
+    /// @brief is already speak finished, does not wait for the chip,
+    /// so the other requests (stop, volume) get the bus between the polls
     /// @return 
     bool isFinished() {
         std::lock_guard<std::mutex> lck(_mtx);
+        if (!_inaction) return true;
+        if (_fault) return false;
+        if (!Pins::read(_rdyPin)) return false;     // nothing from the chip yet
         _inaction = !checkResponse(ISC_TTS_FINISHED_IND, 0x0000, 16); 
         return !_inaction; 
     }
 
+    /// @brief stops the current utterance
+    /// @return true - success
+    bool stop() {
+        std::lock_guard<std::mutex> lck(_mtx);
+        if (!_inaction) return true;
+        if (_fault) return false;
+
+        auto rc = sendMsg(_stopReq) && checkResponse(ISC_TTS_STOP_RESP, 0x0000, 16);
+        // the end of the stopped utterance comes before or after the response
+        auto start = millis();
+        while (millis() - start < _stopWait) {
+            if (Pins::read(_rdyPin)) rc |= checkResponse(ISC_TTS_STOP_RESP, 0x0000, 16);
+            else vTaskDelay(1);
+        }
+        _inaction = false;
+        return rc;
+    }
+
+    /// @brief audio volume
+    /// @param db - volume -48 .. +18 [dB], 0 - default maximum
+    /// @return true - success
+    bool setVolume(int16_t db) {
+        std::lock_guard<std::mutex> lck(_mtx);
+        if (db < volumeMin || db > volumeMax) return false;
+        uint8_t req[Isc::headerSize + 2];
+        Isc::header(req, ISC_AUDIO_VOLUME_REQ, 2);
+        req[4] = db & 0xFF;
+        req[5] = (db >> 8) & 0xFF;
+        if (_fault) return false;
+        return sendMsg(req, sizeof(req)) && checkResponse(ISC_AUDIO_VOLUME_RESP, 0x0000, 16);
+    }
+
+    /// @brief init() finished successfully, never blocks (init() holds the lock for seconds)
+    /// @return true - chip accepts messages
+    bool isReady() const {
+        return _ready;
+    }
+
+    /// @brief a protocol step timed out, lost sync or the chip reported ISC_ERROR_IND,
+    /// the chip accepts nothing until the next successful init()
+    /// @return true - recovery needed
+    bool isFaulted() const {
+        return _fault;
+    }
+
     bool isRunning() {
         std::lock_guard<std::mutex> lck(_mtx);
         return _inaction;
@@ -179,17 +275,61 @@ public:
     }
 
 private:
+    /// @brief one lock for all chips on the SPI buses, held only while a chip is selected,
+    /// never during the RDY wait, so a busy chip does not delay the transfers of the others
+    static std::mutex& busMutex()
+    {
+        static std::mutex mtx;
+        return mtx;
+    }
+
+    /// @brief CS setup inside the bus lock [us]. The datasheet SPI timing asks for SCSX
+    /// low before the first SCLK edge by a setup time in nanoseconds, 1 us covers it
+    /// with margin at any clock of _spiSetting.
+    static constexpr uint32_t csSetup = 1;
+
+    /// @brief chip selected & SPI transaction open for the lifetime of the object
+    class Select
+    {
+    public:
+        /// @param drv - selected chip
+        /// @param pause - pacing before the selection [ms], the bus is free meanwhile,
+        ///                so the other chips are served during it. CS cannot go low
+        ///                without the lock, the chip would clock in the other chips' transfers.
+        Select(S1V30120Driver* drv, uint32_t pause) : _drv(drv), _bus(busMutex(), std::defer_lock)
+        {
+            if (pause) delay(pause);
+            _bus.lock();
+            Pins::write(_drv->_csPin, LOW);
+            delayMicroseconds(csSetup);
+            _drv->_spi->beginTransaction(_drv->_spiSetting);
+        }
+
+        ~Select()
+        {
+            _drv->_spi->endTransaction();
+            Pins::write(_drv->_csPin, HIGH);
+        }
+
+    private:
+        S1V30120Driver* _drv;
+        std::unique_lock<std::mutex> _bus;
+    };
+
     /// @brief reset S1V30120 and init SPI CLK
     void reset()
     {
-        digitalWrite(_mutePin, false);
-        digitalWrite(_spi->pinSS(), HIGH);
-        digitalWrite(_resetPin, LOW);
-        _spi->beginTransaction(_spiSetting);
-        _spi->transfer(0x00);
-        _spi->endTransaction();
+        Pins::write(_mutePin, false);
+        Pins::write(_csPin, HIGH);
+        Pins::write(_resetPin, LOW);
+        {
+            std::lock_guard<std::mutex> bus(busMutex());
+            _spi->beginTransaction(_spiSetting);
+            _spi->transfer(0x00);
+            _spi->endTransaction();
+        }
         delay(10);
-        digitalWrite(_resetPin, HIGH);
+        Pins::write(_resetPin, HIGH);
         delay(150);
     }
 
@@ -197,26 +337,32 @@ private:
     /// @return
     bool version()
     {
-        sendMsg(_verReq, 0x04);
-        while (digitalRead(_rdyPin) == 0);
-        digitalWrite(_spi->pinSS(), LOW);
-        _spi->beginTransaction(_spiSetting);
-        while (_spi->transfer(0x00) != 0xAA);
-
-        for (auto i = 0; i < 20; i++)
+        if (!sendMsg(_verReq)) return false;
+        uint32_t start = Trace::enabled ? micros() : 0;
+        if (!waitRdy(HIGH)) return false;
+        uint32_t cs = Trace::enabled ? micros() : 0;
         {
-            _buffer[i] = _spi->transfer(0x00);
-        }
+            Select sel(this, 0);
+            if (!sync(nullptr)) return false;
+
+            for (auto i = 0; i < 20; i++)
+            {
+                _buffer[i] = _spi->transfer(0x00);
+            }
 
-        sendPadding(16);
-        _spi->endTransaction();
-        digitalWrite(_spi->pinSS(), HIGH);
+            sendPadding(16);
+        }
+        metrics().spiReceived.inc(20 + 16);
+        metrics().iscReceived[Metrics::iscIndex((uint8_t) _buffer[3] << 8 | (uint8_t) _buffer[2])].inc();
         _versionHW = _buffer[4] << 8 | _buffer[5];
         _versionFW = _buffer[6] << 8 | _buffer[7];
         _versionFWFeatures =  (_buffer[11] << 24) | (_buffer[10] << 16) | (_buffer[9] << 8) | _buffer[8];
+        Trace::record(TraceKind::version, (uint8_t) _buffer[3] << 8 | (uint8_t) _buffer[2], 20, _versionHW,
+                      cs - start, Trace::enabled ? micros() - cs : 0);
 
         if (_versionHW != 0x0402)
         {
+            metrics().chipErrors.inc();
             _versionHW = 0;
             _versionFW = 0;
             _versionFWFeatures = 0;
@@ -225,21 +371,80 @@ private:
         return true;
     }
 
+    /// @brief the chip does not respond as expected, nothing is sent until init()
+    void fail()
+    {
+        _fault = true;
+        _ready = false;
+        metrics().chipErrors.inc();
+    }
+
+    /// @brief wait for the RDY level, a short busy wait, then the task sleeps
+    /// between polls, so a task speaking a long text does not starve its core
+    /// @param level HIGH - response is ready, LOW - chip accepts a message
+    /// @return false - timeout, fault
+    bool waitRdy(int level)
+    {
+        auto start = micros();
+        while (Pins::read(_rdyPin) != (level == HIGH))
+        {
+            auto elapsed = micros() - start;
+            if (elapsed > _rdyTimeout * 1000UL)
+            {
+                fail();
+                return false;
+            }
+            if (elapsed > _rdySpin) vTaskDelay(1);
+        }
+        return true;
+    }
+
+    /// @brief skip bytes up to the start of the message (0xAA), the chip is selected
+    /// @param received optional, number of bytes read
+    /// @return false - no start within _syncLimit bytes, fault
+    bool sync(uint32_t* received)
+    {
+        for (uint16_t i = 1; i <= _syncLimit; i++)
+        {
+            if (_spi->transfer(0x00) == 0xAA)
+            {
+                if (received) *received = i;
+                return true;
+            }
+        }
+        metrics().spiReceived.inc(_syncLimit);
+        fail();
+        return false;
+    }
+
+    /// @brief wait for ready and send a constant message
+    template <size_t N>
+    bool sendMsg(const IscFrame<N>& msg)
+    {
+        return sendMsg(msg.bytes, N);
+    }
+
     /// @brief wait for ready and send
     /// @param data
     /// @param len
-    void sendMsg(const uint8_t data[], uint8_t len)
+    /// @return false - the chip is not ready in time
+    bool sendMsg(const uint8_t data[], uint8_t len)
     {
-        while (digitalRead(_rdyPin) == 1);
-        digitalWrite(_spi->pinSS(), LOW);
-        delay(200);
-        _spi->beginTransaction(_spiSetting);
-        _spi->transfer(0xAA);
-        for (auto i = 0; i < len; i++)
+        uint32_t start = Trace::enabled ? micros() : 0;
+        if (!waitRdy(LOW)) return false;
+        uint32_t cs = Trace::enabled ? micros() : 0;
         {
-            _spi->transfer(data[i]);
+            Select sel(this, 200);
+            _spi->transfer(0xAA);
+            for (auto i = 0; i < len; i++)
+            {
+                _spi->transfer(data[i]);
+            }
         }
-        _spi->endTransaction();
+        metrics().spiSent.inc(len + 1);
+        metrics().iscSent[Metrics::iscIndex(data[3] << 8 | data[2])].inc();
+        Trace::record(TraceKind::send, data[3] << 8 | data[2], len, 0, cs - start, Trace::enabled ? micros() - cs : 0);
+        return true;
     }
 
     /// @brief send padding zeros
@@ -261,29 +466,44 @@ private:
     bool checkResponse(uint16_t msg, uint16_t result, uint16_t padding)
     {
         auto rc = false;
+        auto start = micros();
 
-        while (digitalRead(_rdyPin) == 0)
-            ;
-        digitalWrite(_spi->pinSS(), LOW);
-        delay(20);
-        _spi->beginTransaction(_spiSetting);
-        while (_spi->transfer(0x00) != 0xAA)
-            ;
-        for (auto i = 0; i < 6; i++)
+        if (!waitRdy(HIGH)) return false;
+        auto cs = micros();
+        metrics().rdyWait.observe(cs - start);
+        uint32_t received = 0;
         {
-            _buffer[i] = _spi->transfer(0x00);
+            Select sel(this, 20);
+            if (!sync(&received)) return false;
+            for (auto i = 0; i < 6; i++)
+            {
+                _buffer[i] = _spi->transfer(0x00);
+            }
+            sendPadding(padding);
         }
-        sendPadding(padding);
-        _spi->endTransaction();
-        digitalWrite(_spi->pinSS(), HIGH);
 
-        uint16_t val = _buffer[3] << 8 | _buffer[2];
+        uint16_t val = (uint8_t) _buffer[3] << 8 | (uint8_t) _buffer[2];
+        Trace::record(TraceKind::response, val, (uint8_t) _buffer[1] << 8 | (uint8_t) _buffer[0],
+                      (uint8_t) _buffer[5] << 8 | (uint8_t) _buffer[4], cs - start, Trace::enabled ? micros() - cs : 0);
+        metrics().spiReceived.inc(received + 6 + padding);
+        metrics().iscReceived[Metrics::iscIndex(val)].inc();
         if (val == msg)
         {
-            val = _buffer[5] << 8 | _buffer[4];
-            if (val == result)
+            uint16_t code = (uint8_t) _buffer[5] << 8 | (uint8_t) _buffer[4];
+            if (code == result)
                 rc = true;
+            else
+                metrics().chipErrors.inc();
+        }
+        else if (val == ISC_ERROR_IND)
+        {
+            fail();
+        }
+        else if (val == ISC_MSG_BLOCKED_RESP)
+        {
+            metrics().chipErrors.inc();
         }
+        metrics().responseLatency.observe(micros() - start);
         return rc;
     }
 
@@ -291,7 +511,7 @@ private:
     /// @return true - success
     bool run()
     {
-        sendMsg(_runReq, 0x04);
+        if (!sendMsg(_runReq)) return false;
         return checkResponse(ISC_BOOT_RUN_RESP, 0x0001, 8);
     }
 
@@ -301,35 +521,69 @@ private:
     ///  Note: cen be clocked if init data is invalid !!!
     bool test()
     {
-        sendMsg(_testReq, 0x0C);
+        if (!sendMsg(_testReq)) return false;
         return checkResponse(ISC_TEST_RESP, 0x0000, 16);
     }
 
 
-    /// @brief upload firmware (init data) S1V30120_INIT_DATA_ver2_1_6
+    /// @brief upload firmware (init data) S1V30120_INIT_DATA_ver2_1_6. The CRC of the image
+    /// is verified first, a corrupted image is never uploaded. A rejected block is sent again
+    /// after a short pause, a block rejected every time ends the upload. Only a chip that
+    /// stops responding (timeout, lost sync, ISC_ERROR_IND) is reset and the upload starts
+    /// from the beginning.
     /// @return true - success
     bool uploadFW()
     {
-        auto rc = true;
+        auto rc = false;
         uint16_t initDataSize = sizeof(S1V30120_INIT_DATA_ver2_1_6);
-        uint16_t numberOfBlocks = initDataSize / _msgsize;
-        uint16_t lastBlockSize = initDataSize - (numberOfBlocks * _msgsize);
-        uint16_t pos = 0;
-        for (auto part = 0; part < numberOfBlocks; part++)
+        if (crc32_le(0, S1V30120_INIT_DATA_ver2_1_6, initDataSize) != S1V30120_INIT_DATA_CRC)
         {
-            if (!uploadPart(pos, _msgsize))
+            // corrupted image in flash, uploading it does not help
+            metrics().chipErrors.inc();
+            return false;
+        }
+
+        for (uint8_t attempt = 0; attempt < _uploadAttempts; attempt++)
+        {
+            if (attempt > 0)
             {
-                rc = false;
-                break;
+                metrics().uploadRestarts.inc();
+                _fault = false;
+                reset();
+                if (!version())
+                    continue;
+            }
+
+            uint16_t pos = 0;
+            while (pos < initDataSize)
+            {
+                uint16_t len = initDataSize - pos < _msgsize ? initDataSize - pos : _msgsize;
+                if (!uploadBlock(pos, len))
+                    break;
+                pos += len;
             }
-            pos += _msgsize;
+            rc = pos == initDataSize;
+            if (rc || !_fault)
+                break;      // done, or the chip answers and still rejects the block
         }
+        return rc;
+    }
 
-        if (!uploadPart(pos, lastBlockSize))
+    /// @brief one block with retries, a rejected block is sent again after 2, 4, 8 ... ms
+    /// @return false - still rejected, or the chip does not respond (fault)
+    bool uploadBlock(uint16_t fromPos, uint16_t len)
+    {
+        uint32_t backoff = _blockBackoff;
+        for (uint8_t retry = 0; ; retry++)
         {
-            rc = false;
+            if (uploadPart(fromPos, len))
+                return true;
+            if (_fault || retry + 1 >= _blockRetries)
+                return false;
+            metrics().uploadBlockRetries.inc();
+            delay(backoff);
+            backoff *= 2;
         }
-        return rc;
     }
 
 
@@ -340,23 +594,26 @@ private:
     /// @return true - success
     bool uploadPart(uint16_t fromPos, uint16_t len)
     {
-        digitalWrite(_spi->pinSS(), LOW);
-        delay(20);
-        _spi->beginTransaction(_spiSetting);
-        _spi->transfer(0xAA);
-        _spi->transfer((len + 4) & 0xFF);
-        _spi->transfer(((len + 4) & 0xFF00) >> 8);
-        _spi->transfer(0x00);
-        _spi->transfer(0x10);
-
-        for (auto i = 0; i < len; i++)
+        uint32_t cs = Trace::enabled ? micros() : 0;
         {
-            _spi->transfer(S1V30120_INIT_DATA_ver2_1_6[fromPos + i]);
-        }
+            uint8_t head[Isc::headerSize];
+            Isc::header(head, ISC_BOOT_LOAD_REQ, len);
+            Select sel(this, 20);
+            _spi->transfer(0xAA);
+            for (auto ch : head)
+            {
+                _spi->transfer(ch);
+            }
 
-        _spi->endTransaction();
-        delay(1);
-        digitalWrite(_spi->pinSS(), HIGH);
+            for (auto i = 0; i < len; i++)
+            {
+                _spi->transfer(S1V30120_INIT_DATA_ver2_1_6[fromPos + i]);
+            }
+            delay(1);
+        }
+        metrics().spiSent.inc(len + 5);
+        metrics().iscSent[Metrics::iscIndex(ISC_BOOT_LOAD_REQ)].inc();
+        Trace::record(TraceKind::upload, ISC_BOOT_LOAD_REQ, len + 4, fromPos, 0, Trace::enabled ? micros() - cs : 0);
         return checkResponse(ISC_BOOT_LOAD_RESP, 0x0001, 16);
     }
 
@@ -364,7 +621,7 @@ private:
     /// @return 
     bool audioCfg()
     {
-        sendMsg(_audioReq, 0x0C);
+        if (!sendMsg(_audioReq)) return false;
         return checkResponse(ISC_AUDIO_CONFIG_RESP, 0x0000, 16);
     }
 
@@ -372,7 +629,7 @@ private:
     /// @return 
     bool maxVolume()
     {
-        sendMsg(_volumeMaxReq, 0x06);
+        if (!sendMsg(_volumeMaxReq)) return false;
         return checkResponse(ISC_AUDIO_VOLUME_RESP, 0x0000, 16);
     }
 
@@ -382,14 +639,16 @@ private:
     /// @return 
     bool setupTTS(bool epson)
     {
-        sendMsg(epson?_ttsReqEpson:_ttsReqDec, 0x0C);
+        if (!(epson ? sendMsg(_ttsReqEpson) : sendMsg(_ttsReqDec))) return false;
         return checkResponse(ISC_TTS_CONFIG_RESP, 0x0000, 16);
     }
 
 private:
     bool       _inaction {false};   // if true in processor progress
+    std::atomic<bool> _ready {false};   // init() passed
+    std::atomic<bool> _fault {false};   // protocol failure, init() needed
     std::mutex _mtx;         // exclusive access   
-    char _buffer[maximumBufferSize];       // temporary buffer
+    uint8_t _buffer[maximumBufferSize];       // temporary buffer
     uint16_t _versionHW{0};  // version HW
     uint16_t _versionFW{0};  // version FW
     uint32_t _versionFWFeatures{0}; // vertion FW features
@@ -397,21 +656,34 @@ private:
     uint8_t _resetPin{0};
     uint8_t _rdyPin{0};
     uint8_t _mutePin{0};
+    uint8_t _csPin{0};
     const uint16_t _msgsize{2044}; // The size of the message should not exceed 2048 bytes (minus header)
+    const uint32_t _rdySpin{200};  // busy wait for RDY before sleeping [us]
+    const uint32_t _stopWait{20};  // collecting the messages after stop [ms]
+    const uint32_t _rdyTimeout{1000}; // deadline of every RDY wait [ms]
+    const uint16_t _syncLimit{256};   // bytes read before the start of the message
+    const uint8_t _blockRetries{4};   // attempts to send one firmware block
+    const uint32_t _blockBackoff{2};  // first pause before sending the block again [ms]
+    const uint8_t _uploadAttempts{3}; // whole firmware uploads, reset before each one
     const SPISettings _spiSetting{750000, MSBFIRST, SPI_MODE3};
 
-    // messages defs.
-    const uint8_t _testReq[12] = {0x0C, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-    const uint8_t _verReq[4] = {0x04, 0x00, 0x05, 0x00};
-    const uint8_t _runReq[4] = {0x04, 0x00, 0x02, 0x10};
-    const uint8_t _ttsReqEpson[12] = {0x0C, 0x00, ISC_TTS_CONFIG_REQ & 0xFF, (ISC_TTS_CONFIG_REQ & 0xFF00) >> 8,
-                                 TTS_CONFIG_SAMPLE_RATE, TTS_CONFIG_VOICE, TTS_CONFIG_EPSON_PARSE, TTS_CONFIG_LANGUAGE,
-                                 TTS_CONFIG_SPEAK_RATE_LSB, TTS_CONFIG_SPEAK_RATE_MSB, TTS_CONFIG_DATASOURCE, 0x00};
-     const uint8_t _ttsReqDec[12] = {0x0C, 0x00, ISC_TTS_CONFIG_REQ & 0xFF, (ISC_TTS_CONFIG_REQ & 0xFF00) >> 8,
-                                 TTS_CONFIG_SAMPLE_RATE, TTS_CONFIG_VOICE, TTS_CONFIG_DEC_PARSE, TTS_CONFIG_LANGUAGE,
-                                 TTS_CONFIG_SPEAK_RATE_LSB, TTS_CONFIG_SPEAK_RATE_MSB, TTS_CONFIG_DATASOURCE, 0x00};
-    const uint8_t _volumeMaxReq[6] = {0x06, 0x00, 0x0A, 0x00, 0x00, 0x00};
-    const uint8_t _audioReq[13] = {0x0C, 0x00, ISC_AUDIO_CONFIG_REQ & 0xFF, (ISC_AUDIO_CONFIG_REQ & 0xFF00) >> 8,
-                                   AUDIO_CONFIG_STEREO, AUDIO_CONFIG_GAIN, AUDIO_CONFIG_AMP, AUDIO_CONFIG_ASR, AUDIO_CONFIG_AR,
-                                   AUDIO_CONFIG_ATC, AUDIO_CONFIG_ACS, AUDIO_CONFIG_DCA, 0x00};
+    // messages defs., built by the compiler, see isc_msg.h
+    static constexpr auto _testReq = Isc::test();
+    static constexpr auto _verReq = Isc::version();
+    static constexpr auto _stopReq = Isc::stop();
+    static constexpr auto _runReq = Isc::run();
+    static constexpr auto _ttsReqEpson = Isc::ttsConfig<TTS_CONFIG_SAMPLE_RATE, TTS_CONFIG_VOICE, TTS_CONFIG_EPSON_PARSE, TTS_CONFIG_LANGUAGE,
+                                                        TTS_CONFIG_SPEAK_RATE_LSB | (TTS_CONFIG_SPEAK_RATE_MSB << 8), TTS_CONFIG_DATASOURCE>();
+    static constexpr auto _ttsReqDec = Isc::ttsConfig<TTS_CONFIG_SAMPLE_RATE, TTS_CONFIG_VOICE, TTS_CONFIG_DEC_PARSE, TTS_CONFIG_LANGUAGE,
+                                                      TTS_CONFIG_SPEAK_RATE_LSB | (TTS_CONFIG_SPEAK_RATE_MSB << 8), TTS_CONFIG_DATASOURCE>();
+    static constexpr auto _volumeMaxReq = Isc::volume<0>();
+    static constexpr auto _audioReq = Isc::audioConfig<AUDIO_CONFIG_STEREO, AUDIO_CONFIG_GAIN, AUDIO_CONFIG_AMP, AUDIO_CONFIG_ASR,
+                                                       AUDIO_CONFIG_AR, AUDIO_CONFIG_ATC, AUDIO_CONFIG_ACS, AUDIO_CONFIG_DCA>();
+    static_assert(_testReq.length() == sizeof(_testReq.bytes) && _audioReq.length() == 0x0C, "ISC message length");
 };
+
+#ifdef S1V30120_TRACE
+using S1V30120 = S1V30120Driver<IscTrace<>, DefaultPins>;   // -D S1V30120_TRACE, protocol trace on /trace
+#else
+using S1V30120 = S1V30120Driver<NoTrace, DefaultPins>;
+#endif
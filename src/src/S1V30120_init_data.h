@@ -17,6 +17,9 @@
 #include <inttypes.h>
 #include <pgmspace.h>
 
+// CRC32 (zlib) of the array, checked before the firmware is started
+static const uint32_t S1V30120_INIT_DATA_CRC = 0xD554AB75;
+
 // array size is 31208
 static const uint8_t S1V30120_INIT_DATA_ver2_1_6[] PROGMEM  = {
   0x18, 0xf0, 0x9f, 0xe5, 0x18, 0xf0, 0x9f, 0xe5, 0x18, 0xf0, 0x9f, 0xe5, 0x18, 0xf0, 0x9f, 0xe5, 
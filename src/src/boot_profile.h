@@ -0,0 +1,165 @@
+/**
+ * @file boot_profile.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Boot time profiler, stage timestamps kept across the reset in RTC memory
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "metrics.h"
+
+/**
+ * @brief boot stages, chip* are the steps of S1V30120::init() running on its own task
+ * in parallel with wifi and server, the stages do not end in the enum order
+ *
+ */
+enum class BootStage : uint8_t {
+    fs, config, dblReset,
+    chipReset, chipVersion, chipUpload, chipRun, chipTest, chipFwVersion, chipAudio, chipVolume, chipTts,
+    wifi, server, ready,
+    count
+};
+
+/**
+ * @brief Records the time [us since reset] at the end of every boot stage.
+ * The record lives in RTC no-init memory, so the profile of the previous boot,
+ * even an unfinished one, is available after the next reset.
+ *
+ */
+class BootProfile {
+public:
+    static constexpr uint8_t stages = static_cast<uint8_t>(BootStage::count);
+
+private:
+    static constexpr uint32_t _magic = 0xB0075EED;
+
+    struct Record {
+        uint32_t    magic;
+        uint32_t    boot;               // boot counter
+        uint32_t    at[stages];         // end of stage [us], 0 - not reached
+    };
+
+public:
+    /**
+     * @brief copy of both records, the current one keeps changing while the chip task boots
+     *
+     */
+    struct Snapshot {
+        Record      current;
+        Record      last;
+        bool        hasLast;
+    };
+
+private:
+
+    Record      _last {};               // previous boot
+    bool        _hasLast {false};
+
+    static Record& rtc() {
+        static RTC_NOINIT_ATTR Record r;
+        return r;
+    }
+
+    static constexpr const char* _names[stages] = {
+        "fs", "config", "dblreset",
+        "chip_reset", "chip_version", "chip_upload", "chip_run", "chip_test", "chip_fwversion",
+        "chip_audio", "chip_volume", "chip_tts",
+        "wifi", "server", "ready" };
+
+public:
+
+    /**
+     * @brief takes over the previous record and starts a new one, call first in setup()
+     *
+     */
+    void begin() {
+        auto& r = rtc();
+        uint32_t boot = 0;
+        if (r.magic == _magic) {
+            _last = r;
+            _hasLast = true;
+            boot = r.boot + 1;
+        }
+        memset(&r, 0, sizeof(r));
+        r.boot = boot;
+        r.magic = _magic;
+    }
+
+    /**
+     * @brief end of the stage
+     *
+     * @param st - stage
+     */
+    void mark(BootStage st) {
+        rtc().at[static_cast<uint8_t>(st)] = esp_timer_get_time();
+    }
+
+    /**
+     * @brief stage end times [us since reset] of the previous boot as "#BOOT" line
+     *
+     * @param out - e.g. Serial
+     */
+    void report(Print& out) const {
+        if (!_hasLast) return;
+        out.printf("#BOOT %u:", (unsigned) _last.boot);
+        for (uint8_t i = 0; i < stages; i++) {
+            if (!_last.at[i]) continue;
+            out.printf(" %s=%uus", _names[i], (unsigned) _last.at[i]);
+        }
+        out.println();
+    }
+
+    /**
+     * @brief copy of the records, the render is called twice for one scrape (length & content)
+     *
+     * @param out - copy
+     */
+    void snapshot(Snapshot& out) const {
+        out.current = rtc();
+        out.last = _last;
+        out.hasLast = _hasLast;
+    }
+
+    /**
+     * @brief stage end times of the current and the previous boot
+     *
+     * @param sn - copy of the records
+     * @param w - metrics output
+     */
+    static void render(const Snapshot& sn, MetricsWriter& w) {
+        w.type("dectalk_boot_stage_seconds", "gauge");
+        stages2metrics(w, "current", sn.current);
+        if (sn.hasLast) stages2metrics(w, "last", sn.last);
+    }
+
+private:
+
+    static void stages2metrics(MetricsWriter& w, const char* boot, const Record& r) {
+        char labels[48];
+        char value[24];
+        for (uint8_t i = 0; i < stages; i++) {
+            if (!r.at[i]) continue;
+            snprintf(labels, sizeof(labels), "{stage=\"%s\",boot=\"%s\"} ", _names[i], boot);
+            w.put("dectalk_boot_stage_seconds");
+            w.put(labels);
+            w.put(value, snprintf(value, sizeof(value), "%u.%06u\n", (unsigned) (r.at[i] / 1000000), (unsigned) (r.at[i] % 1000000)));
+        }
+    }
+};
+
+/**
+ * @brief the device boot profile
+ *
+ * @return BootProfile&
+ */
+inline BootProfile& bootProfile() {
+    static BootProfile bp;
+    return bp;
+}
@@ -16,6 +16,8 @@
 #include <ESPAsyncWebServer.h>
 
 #include "file_sys.h"
+#include "config_store.h"
+#include "zones.h"
 
 /**
  * @brief Configuration WWW severver
@@ -31,18 +33,26 @@ private:
     const char*     _clat = "lat";  ///> form param
     const char*     _clon = "lon";  ///> form param
     const char*     _ckey = "apikey";  ///> form param
+    const char*     _cbaud = "baud";  ///> form param
+    const char*     _cflow = "flow";  ///> form param
+    const char*     _cdblflash = "dblflash";  ///> form param, checkbox
+    const char*     _czones = "zones";  ///> form param, lines of /zones.txt
     
     AsyncWebServer*     _as    {nullptr};
     ItemFS*             _fs    {nullptr};
+    ConfigStore*        _store {nullptr};
+    uint8_t             _chips {1};
 
  public: 
 
     /**
      * @brief Construct a new Cfg Server object
      * 
-     * @param fs 
+     * @param fs - configuration page & zone table
+     * @param store - configuration record
+     * @param chips - number of S1V30120 chips, validates the zones
      */
-    explicit CfgServer(ItemFS* fs) : _fs(fs) {
+    explicit CfgServer(ItemFS* fs, ConfigStore* store, uint8_t chips = 1) : _fs(fs), _store(store), _chips(chips) {
     } 
 
     /**
@@ -95,42 +105,50 @@ private:
             _as->serveStatic("/", *_fs->getFS(), "/");
 
             _as->on("/", HTTP_POST, [this] (AsyncWebServerRequest *request) {
+                // one batched write of the whole record
+                Configuration cfg;
+                _store->load(cfg);
+                String zones;
+                bool hasZones = false;
+                cfg.dblFlash = request->hasParam(_cdblflash, true);   // unchecked box is not sent
                 auto params = request->params();
                 for(auto i=0; i<params; i++) {
                     AsyncWebParameter* p = request->getParam(i);
                     if(p->isPost()){  
-                        // HTTP POST ssid value
-                        if (p->name() == _cssid) {
-                            _fs->writeItem(ItemFS::Data::ssid,p->value().c_str());
-                            
-                        }
-
-                        if (p->name() == _cpass) {
-                            _fs->writeItem(ItemFS::Data::password, p->value().c_str());
-                            
-                        }
-
-                        if (p->name() == _cservice) {
-                            _fs->writeItem(ItemFS::Data::ip, p->value().c_str());
-                            
-                        }
-
-                        if (p->name() == _clat) {
-                            _fs->writeItem(ItemFS::Data::lat, p->value().c_str());
-                            
-                        }
-
-                        if (p->name() == _clon) {
-                            _fs->writeItem(ItemFS::Data::lon, p->value().c_str());
-                            
+                        if (p->name() == _cssid) cfg.ssid = p->value();
+                        if (p->name() == _cpass) cfg.pass = p->value();
+                        if (p->name() == _cservice) cfg.ip = p->value();
+                        if (p->name() == _clat) cfg.lat = p->value();
+                        if (p->name() == _clon) cfg.lon = p->value();
+                        if (p->name() == _ckey) cfg.key = p->value();
+                        if (p->name() == _cbaud) cfg.baud = p->value().toInt();
+                        if (p->name() == _cflow) cfg.flow = p->value().toInt();
+                        if (p->name() == _czones) {
+                            zones = p->value();
+                            hasZones = true;
                         }
+                    }
+                }
 
-                        if (p->name() == _ckey) {
-                            _fs->writeItem(ItemFS::Data::apikey, p->value().c_str());
-                            
-                        }
-                        
+                if (hasZones) {
+                    // the whole table is rejected, a skipped line would be lost silently
+                    ZoneTable table;
+                    auto bad = table.load(zones, _chips);
+                    if (bad) {
+                        char txt[40];
+                        snprintf(txt, sizeof(txt), "Invalid zone on line %u", bad);
+                        request->send(400, "text/plain", txt);
+                        return;
                     }
+                    if (!_fs->writeItem(ItemFS::Data::zones, zones.c_str())) {
+                        request->send(500, "text/plain", "Zones not saved");
+                        return;
+                    }
+                }
+
+                if (!_store->save(cfg)) {
+                    request->send(500, "text/plain", "Configuration not saved");
+                    return;
                 }
 
                 request->send(200, "text/plain", "Done. Restart....");
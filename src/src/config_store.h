@@ -0,0 +1,198 @@
+/**
+ * @file config_store.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Configuration as one CRC protected record in NVS
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <esp32/rom/crc.h>
+#include "configuration.h"
+#include "file_sys.h"
+
+/**
+ * @brief Whole configuration in one versioned binary record. Two copies are kept
+ * in NVS, a save overwrites the older one, so a power cut during the save leaves
+ * the previous configuration intact. The newer valid copy wins at boot.
+ *
+ */
+class ConfigStore {
+public:
+    static const uint16_t magic = 0xDC5C;
+    static const uint8_t version = 2;
+
+    /**
+     * @brief stored layout, fixed sizes, zero terminated strings
+     *
+     */
+    struct Record {
+        uint16_t    magic;
+        uint8_t     version;
+        uint8_t     flow;
+        uint32_t    generation;     // incremented by every save
+        uint32_t    baud;
+        char        ssid[33];
+        char        pass[65];
+        char        ip[40];
+        char        lat[16];
+        char        lon[16];
+        char        key[64];
+        uint8_t     dblFlash;       // version 2, padding in version 1
+        uint32_t    crc;            // CRC32 of the preceding bytes
+    };
+
+private:
+    Preferences     _prefs;
+    Record          _rec {};        // last loaded / saved copy
+    uint8_t         _slot {0};      // slot of _rec
+    bool            _valid {false};
+
+    const char*     _ns = "dectalk";
+    const char*     _slots[2] = { "cfg0", "cfg1" };
+
+public:
+
+    /**
+     * @brief open the NVS namespace
+     *
+     * @return true - success
+     * @return false
+     */
+    bool init() {
+        return _prefs.begin(_ns, false);
+    }
+
+    /**
+     * @brief close NVS
+     *
+     */
+    void done() {
+        _prefs.end();
+    }
+
+    /**
+     * @brief read the newer valid copy
+     *
+     * @param cfg - output
+     * @return true - configuration found
+     * @return false - no valid copy, cfg untouched
+     */
+    bool load(Configuration& cfg) {
+        Record rec;
+        _valid = false;
+        for (uint8_t i = 0; i < 2; i++) {
+            if (!read(i, rec)) continue;
+            if (_valid && rec.generation - _rec.generation > 0x7FFFFFFF) continue;  // older
+            _rec = rec;
+            _slot = i;
+            _valid = true;
+        }
+        if (_valid) toConfig(_rec, cfg);
+        return _valid;
+    }
+
+    /**
+     * @brief write the configuration into the older slot
+     *
+     * @param cfg - configuration
+     * @return true - success
+     * @return false
+     */
+    bool save(const Configuration& cfg) {
+        bool rc = false;
+        do {
+            Record rec {};
+            rec.magic = magic;
+            rec.version = version;
+            rec.generation = _valid ? _rec.generation + 1 : 1;
+            fromConfig(cfg, rec);
+            rec.crc = crc32_le(0, reinterpret_cast<const uint8_t*>(&rec), offsetof(Record, crc));
+
+            uint8_t slot = _valid ? _slot ^ 1 : 0;
+            if (_prefs.putBytes(_slots[slot], &rec, sizeof(rec)) != sizeof(rec)) break;
+
+            _rec = rec;
+            _slot = slot;
+            _valid = true;
+            rc = true;
+        } while (false);
+        return rc;
+    }
+
+    /**
+     * @brief one-time conversion of the old one-file-per-item configuration
+     *
+     * @param fs - old files
+     * @param cfg - output
+     * @return true - old configuration found and stored
+     * @return false
+     */
+    bool migrate(ItemFS* fs, Configuration& cfg) {
+        bool rc = false;
+        do {
+            Configuration old;
+            old.ssid = fs->readItem(ItemFS::Data::ssid);
+            old.pass = fs->readItem(ItemFS::Data::password);
+            if (old.ssid.isEmpty()) break;
+            old.ip = fs->readItem(ItemFS::Data::ip);
+            old.lat = fs->readItem(ItemFS::Data::lat);
+            old.lon = fs->readItem(ItemFS::Data::lon);
+            old.key = fs->readItem(ItemFS::Data::apikey);
+            auto baud = fs->readInt(ItemFS::Data::baud);
+            if (baud > 0) old.baud = baud;
+            old.flow = fs->readInt(ItemFS::Data::flow);
+            if (!save(old)) break;
+            cfg = old;
+            rc = true;
+        } while (false);
+        return rc;
+    }
+
+private:
+
+    /// @brief valid copy from the slot
+    bool read(uint8_t slot, Record& rec) {
+        if (_prefs.getBytesLength(_slots[slot]) != sizeof(rec)) return false;
+        if (_prefs.getBytes(_slots[slot], &rec, sizeof(rec)) != sizeof(rec)) return false;
+        if (rec.magic != magic || rec.version < 1 || rec.version > version) return false;
+        if (rec.crc != crc32_le(0, reinterpret_cast<const uint8_t*>(&rec), offsetof(Record, crc))) return false;
+        if (rec.version < 2) rec.dblFlash = 0;
+        return true;
+    }
+
+    static void copy(char* dst, size_t size, const String& src) {
+        strncpy(dst, src.c_str(), size - 1);
+        dst[size - 1] = 0;
+    }
+
+    static void fromConfig(const Configuration& cfg, Record& rec) {
+        copy(rec.ssid, sizeof(rec.ssid), cfg.ssid);
+        copy(rec.pass, sizeof(rec.pass), cfg.pass);
+        copy(rec.ip, sizeof(rec.ip), cfg.ip);
+        copy(rec.lat, sizeof(rec.lat), cfg.lat);
+        copy(rec.lon, sizeof(rec.lon), cfg.lon);
+        copy(rec.key, sizeof(rec.key), cfg.key);
+        rec.baud = cfg.baud;
+        rec.flow = cfg.flow;
+        rec.dblFlash = cfg.dblFlash;
+    }
+
+    static void toConfig(const Record& rec, Configuration& cfg) {
+        cfg.ssid = rec.ssid;
+        cfg.pass = rec.pass;
+        cfg.ip = rec.ip;
+        cfg.lat = rec.lat;
+        cfg.lon = rec.lon;
+        cfg.key = rec.key;
+        cfg.baud = rec.baud;
+        cfg.flow = rec.flow;
+        cfg.dblFlash = rec.dblFlash != 0;
+    }
+};
@@ -26,4 +26,7 @@ struct Configuration {
     String lat;
     String lon;
     String key;
+    uint32_t baud {9600};   ///> serial terminal speed
+    uint8_t flow {0};       ///> serial flow control, 0 - none, 1 - XON/XOFF, 2 - RTS/CTS
+    bool dblFlash {false};  ///> double reset marker also in flash, for resets that lose the RTC memory
 };
\ No newline at end of file
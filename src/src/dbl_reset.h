@@ -15,6 +15,15 @@
 #include "file_sys.h"
 #include <esp_system.h>
 
+/**
+ * @brief Double reset detection, the second reset within 5 s opens the web configuration.
+ * The marker lives in RTC no-init memory, it survives the reset button and costs
+ * no flash write. Only resets by the button / power count, a crash or software
+ * reset clears the marker. When the RTC memory is lost (power cycle, EN on the
+ * classic ESP32), the flash marker is used as a fallback if enabled, it is off
+ * by default. The flash is written only when its value changes.
+ *
+ */
 class DblReset {
 public:
    
@@ -22,15 +31,48 @@ public:
 private:
     const int32_t _on  {0x006A0F55};  //6950741
     const int32_t _off {0x0FA65501};  //262558977
+    static const uint32_t _magic = 0xDB1E5E70;
+
+    /**
+     * @brief marker in RTC memory, valid only with the magic and the complement
+     *
+     */
+    struct Marker {
+        uint32_t    magic;
+        uint32_t    state;
+        uint32_t    check;          // ~state
+    };
 
     const uint32_t _startupTime {5000};
     bool           _waitForDbl  {false};
     ItemFS*        _fs          {nullptr};
+    bool           _fallback    {false};    // flash marker allowed
+    bool           _useFlash    {false};    // RTC was lost at this boot
+    int32_t        _flash       {0};        // value in flash, read at this boot
        
+    static Marker& rtc() {
+        static RTC_NOINIT_ATTR Marker m;
+        return m;
+    }
     
 public:
 
-    DblReset(ItemFS* fs): _fs(fs) {
+    /**
+     * @brief Construct a new Dbl Reset object
+     *
+     * @param fs - flash marker
+     * @param flashFallback - true - the flash marker is used when the RTC memory was lost (power cycle)
+     */
+    DblReset(ItemFS* fs, bool flashFallback = false): _fs(fs), _fallback(flashFallback) {
+    }
+
+    /**
+     * @brief enable the flash marker, before isDblRestActivated()
+     *
+     * @param on - true - the flash marker is used when the RTC memory was lost
+     */
+    void setFlashFallback(bool on) {
+        _fallback = on;
     }
 
     void stop() {
@@ -60,18 +102,42 @@ public:
 
 private:
 
+    /// @brief reset by the button or by the power
+    static bool isUserReset() {
+        auto reason = esp_reset_reason();
+        return reason == ESP_RST_POWERON || reason == ESP_RST_EXT || reason == ESP_RST_UNKNOWN;
+    }
+
     bool isSet() {
-        uint32_t rc = 0;
-        if (_fs)  rc = _fs->readInt(ItemFS::Data::dblrst);
-        return rc == _on;
+        auto& m = rtc();
+        bool valid = m.magic == _magic && m.check == ~m.state;
+        if (!isUserReset()) return false;
+        if (valid) return m.state == static_cast<uint32_t>(_on);
+
+        // RTC memory lost
+        if (!_fallback || !_fs) return false;
+        _useFlash = true;
+        _flash = _fs->readInt(ItemFS::Data::dblrst);
+        return _flash == _on;
+    }
+
+    void store(int32_t state) {
+        auto& m = rtc();
+        m.magic = _magic;
+        m.state = state;
+        m.check = ~m.state;
+        if (_useFlash && _flash != state) {
+            _fs->writeInt(ItemFS::Data::dblrst, state);
+            _flash = state;
+        }
     }
 
     void set() {
-        if (_fs)  _fs->writeInt(ItemFS::Data::dblrst,_on);
+        store(_on);
     }
 
     void reset() {
-         if (_fs)  _fs->writeInt(ItemFS::Data::dblrst,_off);
+        store(_off);
     }
 
 };
\ No newline at end of file
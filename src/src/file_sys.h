@@ -24,7 +24,7 @@
  */
 class ItemFS {
 public:
-    enum class Data { dblrst, ssid, password, ip, lat, lon, apikey };
+    enum class Data { dblrst, ssid, password, ip, lat, lon, apikey, baud, flow, zones };
 
 private:
     const char* _dblrst = "/dblrst.txt";
@@ -36,6 +36,9 @@ private:
     const char* _clat = "/lat.txt";
     const char* _clon = "/lon.txt";
     const char* _capikey = "/apikey.txt";
+    const char* _cbaud = "/baud.txt";
+    const char* _cflow = "/flow.txt";
+    const char* _czones = "/zones.txt";
     
 public:
 
@@ -92,6 +95,9 @@ public:
             case Data::lat: path = _clat; break;
             case Data::lon: path = _clon; break;
             case Data::apikey: path = _capikey; break;
+            case Data::baud: path = _cbaud; break;
+            case Data::flow: path = _cflow; break;
+            case Data::zones: path = _czones; break;
         }
         return path;
     }
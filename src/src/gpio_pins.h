@@ -0,0 +1,57 @@
+/**
+ * @file gpio_pins.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Pin policies for the S1V30120 driver - CS, RESET, MUTE & RDY access
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Arduino pin API, works on every platform including the host build
+ *
+ */
+struct ArduinoPins {
+    static void output(uint8_t pin) { pinMode(pin, OUTPUT); }
+    static void input(uint8_t pin) { pinMode(pin, INPUT); }
+    static void write(uint8_t pin, bool level) { digitalWrite(pin, level ? HIGH : LOW); }
+    static bool read(uint8_t pin) { return digitalRead(pin) == HIGH; }
+};
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+
+/**
+ * @brief ESP32 GPIO registers, one store to set or clear an output and one load
+ * to read an input, no pin lookup. The pin direction is set by the Arduino API once.
+ * CS stays a software pin, the hardware CS of the SPI peripheral is not usable:
+ * Arduino-ESP32 sends a long transfer in 64 byte FIFO chunks and releases CS between
+ * them, the chip would lose the ISC frame.
+ */
+struct Esp32Pins {
+    static void output(uint8_t pin) { pinMode(pin, OUTPUT); }
+    static void input(uint8_t pin) { pinMode(pin, INPUT); }
+
+    static inline void write(uint8_t pin, bool level) {
+        if (pin < 32) REG_WRITE(level ? GPIO_OUT_W1TS_REG : GPIO_OUT_W1TC_REG, 1UL << pin);
+        else REG_WRITE(level ? GPIO_OUT1_W1TS_REG : GPIO_OUT1_W1TC_REG, 1UL << (pin - 32));
+    }
+
+    static inline bool read(uint8_t pin) {
+        if (pin < 32) return (REG_READ(GPIO_IN_REG) >> pin) & 1;
+        return (REG_READ(GPIO_IN1_REG) >> (pin - 32)) & 1;
+    }
+};
+
+using DefaultPins = Esp32Pins;
+
+#else
+using DefaultPins = ArduinoPins;
+#endif
@@ -0,0 +1,118 @@
+/**
+ * @file isc_msg.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief ISC messages of S1V30120 built by the compiler
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <inttypes.h>
+#include <stddef.h>
+#include "S1V30120_const.h"
+
+/**
+ * @brief one ISC message - length u16, message id u16 (little endian) and the payload,
+ * the length counts the whole message. The 0xAA start byte is not part of it.
+ *
+ * @tparam N - message size
+ */
+template <size_t N>
+struct IscFrame {
+    static_assert(N >= 4 && N <= 0xFFFF, "ISC message size");
+    static constexpr size_t size = N;
+    uint8_t bytes[N];
+
+    constexpr uint16_t length() const {
+        return bytes[0] | (bytes[1] << 8);
+    }
+
+    constexpr uint16_t id() const {
+        return bytes[2] | (bytes[3] << 8);
+    }
+};
+
+/**
+ * @brief Message descriptors. The constant messages are constexpr objects in flash,
+ * the length is always derived from the payload and the field ranges are checked
+ * by static_assert. Messages with run-time content (speak, volume) get only the header
+ * written by header(), the payload goes straight to the transmit buffer.
+ *
+ */
+namespace Isc {
+
+    static constexpr size_t headerSize = 4;
+
+    /// @brief message with the constant payload
+    template <uint16_t Id, uint8_t... Payload>
+    constexpr IscFrame<headerSize + sizeof...(Payload)> frame() {
+        constexpr uint16_t len = headerSize + sizeof...(Payload);
+        return {{ len & 0xFF, len >> 8, Id & 0xFF, Id >> 8, Payload... }};
+    }
+
+    /**
+     * @brief header of the message in the transmit buffer
+     *
+     * @param buff - at least headerSize bytes
+     * @param id - message id
+     * @param payload - payload size
+     * @return size_t - whole message size
+     */
+    inline size_t header(uint8_t* buff, uint16_t id, size_t payload) {
+        size_t len = headerSize + payload;
+        buff[0] = len & 0xFF;
+        buff[1] = (len >> 8) & 0xFF;
+        buff[2] = id & 0xFF;
+        buff[3] = id >> 8;
+        return len;
+    }
+
+    // boot & system messages without the payload
+    constexpr auto version() { return frame<ISC_VERSION_REQ>(); }
+    constexpr auto run()     { return frame<ISC_BOOT_RUN_REQ>(); }
+    constexpr auto stop()    { return frame<ISC_TTS_STOP_REQ>(); }
+
+    /// @brief registration of the host interface, ISC_TEST_REQ
+    constexpr auto test() { return frame<ISC_TEST_REQ, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00>(); }
+
+    /// @brief analogue gain, ISC_AUDIO_VOLUME_REQ
+    /// @tparam Db -48 .. +18 [dB]
+    template <int16_t Db>
+    constexpr auto volume() {
+        static_assert(Db >= -48 && Db <= 18, "audio_gain_value -48 .. +18 dB");
+        return frame<ISC_AUDIO_VOLUME_REQ, static_cast<uint8_t>(Db & 0xFF), static_cast<uint8_t>((Db >> 8) & 0xFF)>();
+    }
+
+    /// @brief ISC_AUDIO_CONFIG_REQ, see AUDIO_CONFIG_xxx
+    template <uint8_t Stereo, uint8_t Gain, uint8_t Amp, uint8_t SampleRate,
+              uint8_t Routing, uint8_t Tone, uint8_t Clock, uint8_t DacOn>
+    constexpr auto audioConfig() {
+        static_assert(Stereo == 0x00, "audio_stereo - mono only");
+        static_assert(Gain <= 0x43, "audio_gain 0x00 (mute) .. 0x43 (+18 dB)");
+        static_assert(Amp <= 0x01, "audio_amp");
+        static_assert(SampleRate == 0x01, "audio_sample_rate - 11.025 kHz of the TTS");
+        static_assert(Routing == 0x00, "audio_routing - application to DAC");
+        static_assert(Tone == 0x00, "audio_tone_control is deprecated, 0");
+        static_assert(Clock == 0x00, "audio_clock_source - internal");
+        static_assert(DacOn <= 0x01, "DAC_permanently_on");
+        return frame<ISC_AUDIO_CONFIG_REQ, Stereo, Gain, Amp, SampleRate, Routing, Tone, Clock, DacOn>();
+    }
+
+    /// @brief ISC_TTS_CONFIG_REQ, see TTS_CONFIG_xxx
+    template <uint8_t SampleRate, uint8_t Voice, uint8_t EpsonParse, uint8_t Language,
+              uint16_t Rate, uint8_t DataSource>
+    constexpr auto ttsConfig() {
+        static_assert(SampleRate == 0x01, "tts_sample_rate - 11.025 kHz");
+        static_assert(Voice <= 0x08, "tts_voice 0 .. 8");
+        static_assert(EpsonParse <= 0x01, "tts_epson_parse");
+        static_assert(Language == 0x00 || Language == 0x01 || Language == 0x04, "tts_language");
+        static_assert(Rate >= 0x004B && Rate <= 0x0258, "tts_speaking_rate 75 .. 600 words/min");
+        static_assert(DataSource == 0x00, "tts_datasource");
+        return frame<ISC_TTS_CONFIG_REQ, SampleRate, Voice, EpsonParse, Language,
+                     (Rate & 0xFF), (Rate >> 8), DataSource, 0x00>();
+    }
+}
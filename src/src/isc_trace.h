@@ -0,0 +1,131 @@
+/**
+ * @file isc_trace.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Trace policies for the S1V30120 protocol (ISC over SPI)
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @brief kind of the traced protocol step
+ *
+ */
+enum class TraceKind : uint8_t { send = 1, response = 2, upload = 3, version = 4 };
+
+/**
+ * @brief Trace disabled, every call is an empty inline function and
+ * the driver compiled with it contains no trace code at all.
+ *
+ */
+struct NoTrace {
+    static constexpr bool enabled = false;
+
+    static void record(TraceKind, uint16_t, uint16_t, uint16_t, uint32_t, uint32_t) {}
+    static size_t dump(uint8_t*, size_t, size_t) { return 0; }
+    static size_t size() { return 0; }
+};
+
+/**
+ * @brief Timestamped protocol events in a fixed ring buffer. Writers reserve
+ * a slot with one atomic increment, nothing is locked or allocated.
+ *
+ * Binary dump (little endian), decoded by tools/trace_decode.py:
+ *   header: "ISCT", version u8, event size u8, event count u16
+ *   event:  time u32 [us], rdy wait u32 [us], CS hold u32 [us],
+ *           msg u16, len u16, result u16, kind u8, seq u8
+ * result is the response code, the HW version for TraceKind::version
+ * and the image offset for TraceKind::upload.
+ *
+ */
+template <uint16_t Events = 128>
+struct IscTrace {
+    static constexpr bool enabled = true;
+    static constexpr uint8_t version = 1;
+    static constexpr uint8_t headerSize = 8;
+    static constexpr uint8_t eventSize = 20;
+
+    struct Event {
+        uint32_t    time;
+        uint32_t    rdyWait;
+        uint32_t    csHold;
+        uint16_t    msg;
+        uint16_t    len;
+        uint16_t    result;
+        uint8_t     kind;
+        uint8_t     seq;
+    };
+    static_assert(sizeof(Event) == eventSize, "packed trace event");
+
+    /// @brief add event
+    /// @param kind protocol step
+    /// @param msg ISC message id
+    /// @param len message length
+    /// @param result result code or HW version
+    /// @param rdyWait time spent waiting for RDY [us]
+    /// @param csHold time CS was held low [us]
+    static void record(TraceKind kind, uint16_t msg, uint16_t len, uint16_t result, uint32_t rdyWait, uint32_t csHold) {
+        auto n = head().fetch_add(1, std::memory_order_relaxed);
+        auto& ev = ring()[n % Events];
+        ev.time = micros();
+        ev.rdyWait = rdyWait;
+        ev.csHold = csHold;
+        ev.msg = msg;
+        ev.len = len;
+        ev.result = result;
+        ev.kind = static_cast<uint8_t>(kind);
+        ev.seq = n & 0xFF;
+    }
+
+    /// @brief size of the binary dump
+    static size_t size() {
+        return headerSize + count() * eventSize;
+    }
+
+    /// @brief binary dump, oldest event first, window [from, from + cap)
+    /// @return number of bytes stored into out
+    static size_t dump(uint8_t* out, size_t from, size_t cap) {
+        auto n = head().load(std::memory_order_relaxed);
+        uint16_t cnt = count(n);
+        const uint8_t header[headerSize] = { 'I', 'S', 'C', 'T', version, eventSize,
+                                             static_cast<uint8_t>(cnt & 0xFF), static_cast<uint8_t>(cnt >> 8) };
+        size_t stored = 0;
+        size_t pos = 0;
+        for (size_t i = 0; i < headerSize; i++, pos++) {
+            if (pos >= from && stored < cap) out[stored++] = header[i];
+        }
+        for (uint32_t e = n - cnt; e != n; e++) {
+            auto raw = reinterpret_cast<const uint8_t*>(&ring()[e % Events]);
+            for (size_t i = 0; i < eventSize; i++, pos++) {
+                if (pos >= from && stored < cap) out[stored++] = raw[i];
+            }
+        }
+        return stored;
+    }
+
+private:
+    static uint16_t count() {
+        return count(head().load(std::memory_order_relaxed));
+    }
+
+    static uint16_t count(uint32_t n) {
+        return n < Events ? n : Events;
+    }
+
+    static std::atomic<uint32_t>& head() {
+        static std::atomic<uint32_t> h {0};
+        return h;
+    }
+
+    static Event* ring() {
+        static Event r[Events];
+        return r;
+    }
+};
@@ -0,0 +1,216 @@
+/**
+ * @file line_server.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Raw TCP line protocol server
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <AsyncTCP.h>
+#include "talk_queue.h"
+#include "talk_stream.h"
+
+/**
+ * @brief Plain TCP listener for scripts and gateways, e.g. echo "hello" | nc dectalk 7000
+ * Every line terminated by LF (CR is ignored) is queued as an utterance and answered by
+ *   "OK <id> <eta ms>\n" - queued, the estimated time until the speech starts
+ *   "ERROR <id>\n"      - queue is full, the line (or its tail) was dropped
+ * Each connection uses a preallocated slot, no String or heap is used per line.
+ * Answers that do not fit the TCP send buffer wait in the slot and are sent
+ * as the client acknowledges data. A client that does not read its answers
+ * until the slot overflows is disconnected, an answer is never skipped.
+ *
+ */
+class LineServer {
+public:
+    static const uint8_t maxClients = 4;
+    static const uint16_t maxPending = 256;     // answers waiting for the TCP buffer [bytes]
+
+private:
+
+    /**
+     * @brief connection slot
+     *
+     */
+    struct Slot {
+        LineServer*     server {nullptr};
+        AsyncClient*    client {nullptr};   // nullptr - free slot
+        bool            empty  {true};      // no character of the current line yet
+        TalkStream      stream {nullptr};
+        uint16_t        pending {0};        // answers not sent yet
+        char            out[maxPending];
+    };
+
+    AsyncServer*    _srv   {nullptr};
+    TalkQueue*      _queue {nullptr};
+    Slot            _slots[maxClients];
+
+public:
+
+    /**
+     * @brief Construct a new Line Server object
+     *
+     * @param queue - queue of utterances
+     */
+    explicit LineServer(TalkQueue* queue) : _queue(queue) {
+        for (auto& slot : _slots) slot.server = this;
+    }
+
+    /**
+     * @brief Destroy the Line Server object
+     *
+     */
+    ~LineServer() {
+        done();
+    }
+
+    /**
+     * @brief start listening
+     *
+     * @param port - listen port
+     * @return true - success
+     * @return false
+     */
+    bool init(uint16_t port = 7000) {
+        bool rc = false;
+        do {
+            if (_srv) done();
+            if (!_queue) break;
+            _srv = new AsyncServer(port);
+            if (_srv == nullptr) break;
+
+            _srv->onClient([] (void* arg, AsyncClient* client) {
+                static_cast<LineServer*>(arg)->connect(client);
+            }, this);
+            _srv->setNoDelay(true);
+            _srv->begin();
+            rc = true;
+        } while (false);
+        return rc;
+    }
+
+    /**
+     * @brief down server
+     *
+     */
+    void done() {
+        if (_srv) delete(_srv);
+        _srv = nullptr;
+    }
+
+private:
+
+    /// @brief new connection, takes a free slot or refuses the client
+    void connect(AsyncClient* client) {
+        Slot* slot = nullptr;
+        for (auto& s : _slots) {
+            if (!s.client) {
+                slot = &s;
+                break;
+            }
+        }
+
+        if (!slot) {
+            client->close(true);
+            delete client;
+            return;
+        }
+
+        slot->client = client;
+        slot->empty = true;
+        slot->stream = TalkStream(_queue);
+        slot->pending = 0;
+
+        client->setNoDelay(true);
+        client->onData([] (void* arg, AsyncClient* c, void* data, size_t len) {
+            auto s = static_cast<Slot*>(arg);
+            s->server->receive(*s, static_cast<const uint8_t*>(data), len);
+        }, slot);
+        client->onDisconnect([] (void* arg, AsyncClient* c) {
+            auto s = static_cast<Slot*>(arg);
+            s->client = nullptr;
+            delete c;
+        }, slot);
+        client->onTimeout([] (void* arg, AsyncClient* c, uint32_t time) {
+            c->close();
+        }, slot);
+        // room in the send buffer for the waiting answers
+        client->onAck([] (void* arg, AsyncClient* c, size_t len, uint32_t time) {
+            auto s = static_cast<Slot*>(arg);
+            s->server->send(*s);
+        }, slot);
+        client->onPoll([] (void* arg, AsyncClient* c) {
+            auto s = static_cast<Slot*>(arg);
+            s->server->send(*s);
+        }, slot);
+    }
+
+    /// @brief splits received data into lines
+    void receive(Slot& slot, const uint8_t* data, size_t len) {
+        size_t from = 0;
+        for (size_t i = 0; i < len; i++) {
+            if (data[i] == '\n') {
+                std::string_view txt(reinterpret_cast<const char*>(data + from), i - from);
+                if (slot.empty && txt.size() <= S1V30120::maximumMsgSize && TalkStream::isCollapsed(txt)) {
+                    // whole line in this segment and unchanged by the stream, straight into the queue slot
+                    uint32_t id = 0;
+                    auto ok = _queue->push(txt, &id);
+                    answer(slot, ok, id);
+                } else {
+                    slot.stream.feed(data + from, i - from);
+                    if (!slot.empty || i > from) line(slot);
+                }
+                slot.empty = true;
+                from = i + 1;
+            }
+        }
+
+        if (from < len) {
+            slot.stream.feed(data + from, len - from);
+            slot.empty = false;
+        }
+    }
+
+    /// @brief complete line, queue the rest and answer
+    void line(Slot& slot) {
+        auto ok = slot.stream.finish();
+        auto id = slot.stream.lastId();
+        slot.stream = TalkStream(_queue);
+        if (id == 0) return;    // empty line
+        answer(slot, ok, id);
+    }
+
+    /// @brief "OK id eta" or "ERROR id" to the client
+    void answer(Slot& slot, bool ok, uint32_t id) {
+        char buff[32];
+        int len = ok ? snprintf(buff, sizeof(buff), "OK %u %u\n", (unsigned) id, (unsigned) _queue->eta())
+                     : snprintf(buff, sizeof(buff), "ERROR %u\n", (unsigned) id);
+        if (!slot.client) return;
+        if (slot.pending + len > maxPending) {
+            // the client does not read the answers
+            slot.client->close();
+            return;
+        }
+        memcpy(slot.out + slot.pending, buff, len);
+        slot.pending += len;
+        send(slot);
+    }
+
+    /// @brief waiting answers into the TCP send buffer, as much as fits
+    void send(Slot& slot) {
+        if (!slot.client || slot.pending == 0) return;
+        size_t len = slot.client->space();
+        if (len > slot.pending) len = slot.pending;
+        if (len == 0) return;
+        len = slot.client->add(slot.out, len);
+        if (len == 0) return;
+        slot.client->send();
+        slot.pending -= len;
+        memmove(slot.out, slot.out + len, slot.pending);
+    }
+};
@@ -13,12 +13,22 @@
 #include <string.h>
 #include "S1V30120.h"
 #include "cfg_server.h"
+#include "config_store.h"
 #include "ap.h"
 #include "configuration.h"
 #include "dbl_reset.h"
 #include "build_in_led.h"
 #include <WiFi.h>
+#include "wifi_link.h"
 #include "talk_server.h"
+#include "talk_queue.h"
+#include "line_server.h"
+#include "udp_server.h"
+#include "boot_profile.h"
+#include "tasks.h"
+#include "serial_ingest.h"
+#include "synth_pool.h"
+#include "zones.h"
 
 // ESP32 - SPI - default pins
 #define VSPI_MISO MISO
@@ -31,33 +41,72 @@
 #define S1V30120_RDY  34
 #define S1V30120_MUTE 12
 
+// S1V30120 chips on VSPI, each one with its own pins & synthesizer task
+struct ChipPins { int8_t cs; uint8_t rst, rdy, mute; };
+const ChipPins chipPins[] = {
+  { VSPI_SS, S1V30120_RST, S1V30120_RDY, S1V30120_MUTE },
+  // { 4, 14, 35, 27 },   // next chip: CS, RESET, RDY, MUTE
+};
+static_assert(sizeof(chipPins) / sizeof(chipPins[0]) <= SynthPool::maxChips, "too many S1V30120 chips");
+
+// serial terminal - hardware flow control
+#define SERIAL_RTS 25
+#define SERIAL_CTS 26
+
 // TXT
 const char *readyTxt = "[:name 3]  system ready"; 
 const char *readylbl = "ready"; 
 const char *waitlbl = "wait";
 const char *errorlbl = "#error S1V30120"; 
-const char *limitlbl = "limit error"; 
+const char *recoverlbl = "#recovering S1V30120";
+const char *recoveredlbl = "#S1V30120 recovered";
+const char *tracecmd = "#trace"; 
+
+// tasks
+const uint32_t housePeriod = 20;    // [ms]
+const uint32_t ledPeriod = 50;      // [ms]
+const uint32_t wifiPeriod = 100;    // [ms]
+
+// S1V30120 recovery
+const uint32_t speakTimeout = 60000;    // longest utterance [ms]
+const uint32_t recoverMinDelay = 500;   // [ms]
+const uint32_t recoverMaxDelay = 30000; // [ms]
+const uint8_t recoverReport = 3;        // failed attempts before the error is reported
 
 
 
 // globals
 SPIClass *vspi = nullptr;
-S1V30120 *talker = nullptr;
+SynthPool synth;
+ZoneTable zones;
 TalkServer *talsrv = nullptr;
-String msg;
+LineServer *lnsrv = nullptr;
+UdpServer *udpsrv = nullptr;
+TalkQueue queue;
+SerialIngest console(&Serial, &queue);
+SerialFrame *frames = nullptr;
+bool wifiReported = false;
+bool booted = false;
 ItemFS ifs;
+ConfigStore store;
 Configuration cfg;
-DblReset dbl(&ifs);
+WifiLink wifi(&cfg);
+DblReset dbl(&ifs);         // flash fallback from the configuration
 BuildInLed  binled(2);
 
 
+/// @brief configuration record from NVS, the old configuration files are converted once
 bool loadConfig() {
-  bool rc = true;
-  cfg.ssid = ifs.readItem(ItemFS::Data::ssid);
-  cfg.pass = ifs.readItem(ItemFS::Data::password);
-  cfg.ip = ifs.readItem(ItemFS::Data::ip);
-
-  if (cfg.ssid.isEmpty() || cfg.pass.isEmpty()) rc = false;
+  bool rc = false;
+  do {
+    if (!store.init()) break;
+    if (!store.load(cfg) && !store.migrate(&ifs, cfg)) break;
+    cfg.baud = SerialIngest::validBaud(cfg.baud);
+    cfg.flow = static_cast<uint8_t>(SerialIngest::validFlow(cfg.flow));
+
+    if (cfg.ssid.isEmpty() || cfg.pass.isEmpty()) break;
+    rc = true;
+  } while (false);
   return rc;
 }
 
@@ -66,7 +115,7 @@ bool loadConfig() {
 void webConfig() {
   
     AP ap;
-    CfgServer ws(&ifs);
+    CfgServer ws(&ifs, &store, sizeof(chipPins) / sizeof(chipPins[0]));
 
     if (ap.init()) {
        binled.setState(BuildInLed::State::blink);
@@ -85,14 +134,212 @@ void webConfig() {
     while(true) { binled.update(); }
 }
 
+/// @brief S1V30120 reset, firmware upload and configuration, takes seconds
+bool chipInit(Voice& v) {
+  auto ok = v.index > 0 ? v.chip->init() : v.chip->init(false, [] (S1V30120::InitStep step) {
+        bootProfile().mark(static_cast<BootStage>(static_cast<uint8_t>(BootStage::chipReset) + static_cast<uint8_t>(step)));
+      });
+  v.failed = !ok;
+  tasks().set(ok ? Tasks::chipReady : Tasks::chipFailed);
+  return ok;
+}
+
+/// @brief S1V30120 reset, firmware upload and configuration again, until it succeeds.
+/// The queue keeps accepting utterances meanwhile, the other chips speak them.
+void chipRecover(Voice& v) {
+  auto start = esp_timer_get_time();
+  uint32_t backoff = recoverMinDelay;
+  uint8_t attempt = 0;
+  if (!synth.isReady()) tasks().clear(Tasks::chipReady);
+  console.printf("%s %u\n", recoverlbl, v.index);
+  // no broadcast waits for the chip meanwhile
+  if (auto id = queue.setReady(v.index, false)) synth.withdraw(id);
+
+  while (!v.chip->init()) {
+    // still dead, report it and try less often
+    if (++attempt == recoverReport && !v.failed) {
+      v.failed = true;
+      tasks().set(Tasks::chipFailed);
+      console.printf("%s %u\n", errorlbl, v.index);
+    }
+    SynthPool::serve(v);
+    vTaskDelay(pdMS_TO_TICKS(backoff));
+    backoff = backoff * 2 < recoverMaxDelay ? backoff * 2 : recoverMaxDelay;
+  }
+
+  metrics().chipRecoveries.inc();
+  metrics().chipRecovery.store(esp_timer_get_time() - start, std::memory_order_relaxed);
+  v.failed = false;
+  queue.setReady(v.index, true);
+  if (!synth.isFailed()) tasks().clear(Tasks::chipFailed);
+  tasks().set(Tasks::chipReady);
+  console.printf("%s %u\n", recoveredlbl, v.index);
+}
+
+/// @brief speak one utterance and wait for its end
+/// @param started - in/out, TalkEvent::started already reported
+/// @return false - chip failure, the utterance is to be replayed
+bool speakUtterance(Voice& v, bool& started) {
+  if (!v.chip->speak(v.utterance.text, v.utterance.len, false, true)) return false;
+  if (!started) queue.notify(TalkEvent::started, v.utterance.id);
+  started = true;
+  if (synth.startSpeaking()) tasks().set(Tasks::speaking);
+  zones.output(v.index, v.utterance.zones, true);
+  console.println(waitlbl);
+
+  auto rc = true;
+  auto start = millis();
+  while (!v.chip->isFinished()) {
+    if (v.chip->isFaulted() || millis() - start > speakTimeout) {
+      rc = false;
+      break;
+    }
+    SynthPool::serve(v);
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  zones.output(v.index, v.utterance.zones, false);
+  if (synth.stopSpeaking()) tasks().clear(Tasks::speaking);
+  return rc;
+}
+
+/// @brief synthesizer task, core 1 - one per chip, owns its S1V30120, speaks the queued
+/// utterances routed to it, re-initializes the chip after a failure and replays the interrupted utterance.
+/// Stop & volume of the other tasks are executed here too.
+void synthTask(void* arg) {
+  auto& v = *static_cast<Voice*>(arg);
+  if (!chipInit(v)) chipRecover(v);
+
+  while (true) {
+    SynthPool::serve(v);
+    if (!queue.pop(v.utterance, v.index)) {
+      // woken up by TalkQueue::push or by a command
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      continue;
+    }
+
+    // broadcast - all chips start together, the last one reports the start & the end
+    auto broadcast = v.utterance.copies > 1;
+    bool started = broadcast && !synth.arrive(v, speakTimeout);
+    while (!speakUtterance(v, started)) chipRecover(v);
+
+    queue.done(v.index);
+    if (!broadcast || synth.finish(v.utterance)) queue.notify(TalkEvent::finished, v.utterance.id);
+    console.println(readylbl);
+  }
+}
+
+/// @brief boot progress running in parallel - wifi connection, chip ready & fatal chip error
+void bootUpdate() {
+  if (booted) return;
+
+  auto bits = tasks().bits();
+  if ((bits & Tasks::chipFailed) && !(bits & Tasks::chipReady)) {
+    console.println(errorlbl);
+    booted = true;
+    return;
+  }
+
+  if (!wifiReported && (bits & Tasks::wifiUp)) {
+    wifiReported = true;
+    bootProfile().mark(BootStage::wifi);
+  }
+
+  if (wifiReported && (bits & Tasks::chipReady)) {
+    bootProfile().mark(BootStage::ready);
+    tasks().report(console);
+    booted = true;
+  }
+}
+
+/// @brief LED task, core 0 - LED state from the event bits
+void ledTask(void*) {
+  TickType_t wake = xTaskGetTickCount();
+  while (true) {
+    auto bits = tasks().bits();
+    if (bits & Tasks::chipFailed) binled.setState(BuildInLed::State::error);
+    else if (!(bits & Tasks::wifiUp)) binled.setState(BuildInLed::State::connecting);
+    else if (bits & Tasks::speaking) binled.setState(BuildInLed::State::on);
+    else binled.setState(BuildInLed::State::off);
+    binled.update();
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(ledPeriod));
+  }
+}
+
+/// @brief housekeeping task, core 0 - boot progress, double reset & web sockets.
+/// Runs with a fixed period, the wake-up jitter is exported by /metrics.
+void houseTask(void*) {
+  const TickType_t period = pdMS_TO_TICKS(housePeriod);
+  TickType_t wake = xTaskGetTickCount();
+  int64_t last = esp_timer_get_time();
+
+  while (true) {
+    vTaskDelayUntil(&wake, period);
+    int64_t now = esp_timer_get_time();
+    int64_t late = now - last - housePeriod * 1000LL;
+    metrics().tickJitter.observe(late < 0 ? -late : late);
+    last = now;
+
+    bootUpdate();
+    dbl.update();
+    talsrv->update();
+  }
+}
+
+/// @brief wifi supervisor task, core 0 - connects, reconnects with backoff,
+/// the speech goes on without network
+void wifiTask(void*) {
+  bool reconnect = false;
+  while (true) {
+    wifi.update();
+    bool up = (tasks().bits() & Tasks::wifiUp) != 0;
+    if (wifi.isConnected() && !up) {
+      tasks().set(Tasks::wifiUp);
+      console.print("#IP:");
+      console.println(WiFi.localIP());
+      // the TCP listeners survive, the UDP socket is bound again
+      if (reconnect && udpsrv && !udpsrv->restart()) console.println("#UDP restart failed");
+      reconnect = true;
+    } else if (!wifi.isConnected() && up) {
+      tasks().clear(Tasks::wifiUp);
+      console.println("#WiFi lost");
+    }
+    vTaskDelay(pdMS_TO_TICKS(wifiPeriod));
+  }
+}
+
+/// @brief protocol trace as hex lines "#TRACE ...", decoded by tools/trace_decode.py
+void dumpTrace() {
+  // one consistent copy like /trace, the ring keeps moving while the lines are printed
+  auto len = S1V30120::TracePolicy::size();
+  auto copy = static_cast<uint8_t*>(malloc(len));
+  if (!copy) {
+    Serial.println("#TRACE no memory");
+    return;
+  }
+  len = S1V30120::TracePolicy::dump(copy, 0, len);
+  for (size_t pos = 0; pos < len; pos += 32) {
+    Serial.print("#TRACE ");
+    for (size_t i = pos; i < len && i < pos + 32; i++) Serial.printf("%02x", copy[i]);
+    Serial.println();
+  }
+  free(copy);
+}
+
+/// @brief serial task, core 0 - terminal input & buffered output
+void serialTask(void*) {
+  console.run();
+}
+
 /// @brief terminal input & web input
 void setup()
 {
   
-  // sets serial to slow, compatible with retro computers 
-  Serial.begin(9600);
+  // sets serial to slow, compatible with retro computers, the configured speed is set later
+  Serial.begin(SerialIngest::defaultBaud);
+  bootProfile().begin();
   delay(100);
   Serial.println();
+  bootProfile().report(Serial);
   
   binled.setState(BuildInLed::State::off);
 
@@ -101,13 +348,17 @@ void setup()
      binled.setState(BuildInLed::State::error);
     while(true) { binled.update(); }
   }
+  bootProfile().mark(BootStage::fs);
   
   if (!loadConfig()) {
     Serial.printf("#configuration not found, use web config\n"); 
     webConfig();
   } 
+  bootProfile().mark(BootStage::config);
 
-  // configuration - double reset 
+  // configuration - double reset, EN is a power-on reset on the classic ESP32, the RTC marker
+  // does not survive it, the flash marker is opt-in
+  dbl.setFlashFallback(cfg.dblFlash);
   if (dbl.isDblRestActivated()) {
         Serial.println("#double Reset");
         dbl.stop();
@@ -115,122 +366,73 @@ void setup()
         ifs.dumpFiles();
         webConfig();
   } 
+  bootProfile().mark(BootStage::dblReset);
 
   vspi = new SPIClass(VSPI);
   vspi->begin(VSPI_SCLK, VSPI_MISO, VSPI_MOSI, VSPI_SS);
-  talker = new S1V30120(vspi, S1V30120_RST, S1V30120_RDY, S1V30120_MUTE);
+  for (auto& p : chipPins) synth.add(new S1V30120(vspi, p.rst, p.rdy, p.mute, p.cs));
   
-  // decltalk mode
-  if (!talker->init(false))
-  {
-      Serial.println(errorlbl);
-      binled.setState(BuildInLed::State::error);
-      while(true) { binled.update(); }
+  if (zones.init(&ifs, synth.size())) Serial.printf("#zones: %u\n", zones.size());
+  queue.setZones(&zones);
+
+  // decltalk mode, the firmware uploads run on the synthesizer tasks in parallel with wifi & servers
+  static char synthNames[SynthPool::maxChips][8];
+  tasks().init();
+  for (uint8_t i = 0; i < synth.size(); i++) {
+    snprintf(synthNames[i], sizeof(synthNames[i]), "synth%u", i);
+    auto task = tasks().start(synthTask, synthNames[i], 4096, 3, Tasks::synthCore, &synth.voice(i));
+    synth.attach(i, task);
+    queue.addConsumer(task);
   }
 
-  // connect to wifi
+  // connect to wifi, the servers accept and queue requests before the chip is ready
   binled.setState(BuildInLed::State::connecting);
-  WiFi.begin(cfg.ssid.c_str(), cfg.pass.c_str());
-  while (WiFi.status() != WL_CONNECTED) {
-    delay(100);
-  }
-
-  Serial.print("#IP:");
-  Serial.println(WiFi.localIP());
- 
-  binled.setState(BuildInLed::State::off);
-  binled.update();
+  if (!wifi.init()) console.println("#invalid static IP");
+  tasks().start(wifiTask, "wifi", 4096, 1, Tasks::netCore);
 
   /*
   // detail HW info
   Serial.print("#HW:");
-  Serial.println(talker->getHWVersion(), HEX);
+  Serial.println(synth.primary()->getHWVersion(), HEX);
   Serial.print("#FW:");
-  Serial.println(talker->getFWVersion(), HEX);
+  Serial.println(synth.primary()->getFWVersion(), HEX);
   Serial.print("#FEAT:");
-  Serial.println(talker->getFWFeatures(), HEX);
+  Serial.println(synth.primary()->getFWFeatures(), HEX);
   */
 
-  binled.setState(BuildInLed::State::on);
-  talker->speak(readyTxt, false, true);
-  while (!talker->isFinished()) { binled.update(); }
-  binled.setState(BuildInLed::State::off);
-  binled.update();
-
-  Serial.println(readylbl);
-  msg.clear();
-
-  talsrv = new TalkServer(&ifs, talker, &binled);
+  // terminal, configured speed & flow control
+  console.init(cfg.baud, static_cast<SerialIngest::FlowControl>(cfg.flow), SERIAL_RTS, SERIAL_CTS);
+  console.setCommand([] (const char* line, size_t len) {
+    if (!S1V30120::TracePolicy::enabled || strcmp(line, tracecmd) != 0) return false;
+    dumpTrace();
+    return true;
+  });
+  frames = new SerialFrame(&queue, &synth);
+  console.setFrames(frames);
+
+  udpsrv = new UdpServer(&queue);
+  udpsrv->init(7000);
+
+  talsrv = new TalkServer(&ifs, synth.primary(), &binled, &queue);
+  talsrv->attach(udpsrv);
   talsrv->init(80);
   talsrv->serveTalkPage();
 
-}
+  lnsrv = new LineServer(&queue);
+  lnsrv->init(7000);
+  bootProfile().mark(BootStage::server);
 
-void flushInbound() {
-  while(Serial.available() > 0) {
-      Serial.read();
-    }
-}
-
-void serialupdate() {
-  // serial  
-    while (Serial.available() > 0)
-    {
-      char ch = Serial.read();
-     
-      // echo
-      Serial.print(ch);
-      if (ch == 8 && msg.length() > 0) {
-         // backspace
-         msg.remove(msg.length()-1);
-         continue;
-      }
-
-      if (ch == '\r')
-      {
-        Serial.print(msg.c_str());
-        talker->speak(msg, false);
-        binled.setState(BuildInLed::State::on);
-        while (!talker->isFinished())  { binled.update(); }
-        binled.setState(BuildInLed::State::off);
-        binled.update();
-
-        msg.clear();
-        Serial.println();
-        Serial.println(readylbl);
-        flushInbound();
-      }
-
-      // ignore LF
-      if (ch == '\n')
-        continue;
-      
-      // maximum message size overflowed 
-      if (msg.length() >= talker->maximumMsgSize) {
-        Serial.println(limitlbl);
-        msg.clear();
-        continue;
-      }
-
-      msg += ch;
-    }
-}
+  // spoken first, as soon as the chip is ready
+  queue.push(readyTxt, strlen(readyTxt), nullptr, false, "all");
 
-void httpUpdate() {
+  tasks().start(serialTask, "serial", 4096, 2, Tasks::netCore);
+  tasks().start(houseTask, "house", 4096, 1, Tasks::netCore);
+  tasks().start(ledTask, "led", 2048, 1, Tasks::netCore);
 
-  if (talker->isRunning()) {
-    Serial.println(waitlbl);
-    while (!talker->isFinished())  { binled.update(); }
-    binled.setState(BuildInLed::State::off);
-    binled.update();
-    Serial.println(readylbl);
-  }
-  
 }
 
+/// @brief all work is done by the tasks, see setup()
 void loop()
 {
-  serialupdate();
-  httpUpdate();
-  dbl.update();
+  vTaskDelete(nullptr);
 }
@@ -0,0 +1,385 @@
+/**
+ * @file metrics.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Counters & histograms exported in Prometheus text format
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "S1V30120_const.h"
+
+/**
+ * @brief Lock free counter, one cell per core, the cells are summed when read.
+ * Writers never contend across cores and readers never block writers.
+ *
+ */
+class Counter {
+private:
+    std::atomic<uint32_t> _cell[2];
+
+public:
+    Counter() {
+        _cell[0].store(0, std::memory_order_relaxed);
+        _cell[1].store(0, std::memory_order_relaxed);
+    }
+
+    void inc(uint32_t n = 1) {
+        _cell[xPortGetCoreID() & 1].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint32_t value() const {
+        return _cell[0].load(std::memory_order_relaxed) + _cell[1].load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief 64 bit counter from 32 bit cells, one low & carry word per core like Counter.
+ * 64 bit atomics are not lock free on Xtensa (libatomic takes a lock), so the writers
+ * stay on 32 bit fetch_add and the value is widened when read.
+ * Used for the sums of microseconds that would wrap in 32 bits.
+ *
+ */
+class Counter64 {
+private:
+    std::atomic<uint32_t> _low[2];
+    std::atomic<uint32_t> _high[2];             // carries of _low
+    mutable std::atomic<uint64_t> _seen[2];     // readers only, the carry of a racing write
+
+public:
+    Counter64() {
+        for (uint8_t c = 0; c < 2; c++) {
+            _low[c].store(0, std::memory_order_relaxed);
+            _high[c].store(0, std::memory_order_relaxed);
+            _seen[c].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void inc(uint32_t n = 1) {
+        auto c = xPortGetCoreID() & 1;
+        auto old = _low[c].fetch_add(n, std::memory_order_relaxed);
+        if (static_cast<uint32_t>(old + n) < old) _high[c].fetch_add(1, std::memory_order_release);
+    }
+
+    uint64_t value() const {
+        return cell(0) + cell(1);
+    }
+
+private:
+    /// @brief 64 bit value of the cell, never below an earlier read - the wrap of _low
+    /// is visible before the writer adds the carry
+    uint64_t cell(uint8_t c) const {
+        uint32_t high;
+        uint32_t low;
+        do {
+            high = _high[c].load(std::memory_order_acquire);
+            low = _low[c].load(std::memory_order_relaxed);
+        } while (high != _high[c].load(std::memory_order_acquire));
+        uint64_t v = (static_cast<uint64_t>(high) << 32) | low;
+        uint64_t seen = _seen[c].load(std::memory_order_relaxed);
+        if (v < seen) v += 1ULL << 32;
+        if (v > seen) _seen[c].store(v, std::memory_order_relaxed);
+        return v;
+    }
+};
+
+/**
+ * @brief Histogram of durations in microseconds with fixed buckets.
+ * The sum is kept in microseconds in 64 bits, it never wraps.
+ *
+ */
+class Histogram {
+public:
+    static const uint8_t buckets = 9;
+    static constexpr uint32_t bounds[buckets] = { 50, 100, 500, 1000, 5000, 20000, 100000, 500000, 2000000 };     // [us]
+    static constexpr const char* labels[buckets] = { "0.00005", "0.0001", "0.0005", "0.001", "0.005", "0.02", "0.1", "0.5", "2" };
+
+    /**
+     * @brief copy of the values
+     *
+     */
+    struct Values {
+        uint32_t    count[buckets + 1];     // last one is +Inf
+        uint64_t    sum;                    // [us]
+    };
+
+private:
+    Counter _count[buckets + 1];                 // last one is +Inf
+    Counter64 _sum;
+
+public:
+    void observe(uint32_t us) {
+        uint8_t i = 0;
+        while (i < buckets && us > bounds[i]) i++;
+        _count[i].inc();
+        _sum.inc(us);
+    }
+
+    uint32_t count(uint8_t bucket) const {
+        return _count[bucket].value();
+    }
+
+    uint64_t sum() const {
+        return _sum.value();
+    }
+
+    void copy(Values& out) const {
+        for (uint8_t i = 0; i <= buckets; i++) out.count[i] = count(i);
+        out.sum = sum();
+    }
+};
+
+/**
+ * @brief Writes text into a window [from, from + cap) of the virtual output.
+ * The whole text is rendered on every call and only the requested part is kept,
+ * so a response can be produced piece by piece without any allocation.
+ *
+ */
+class MetricsWriter {
+private:
+    char*   _buf  {nullptr};
+    size_t  _from {0};
+    size_t  _cap  {0};
+    size_t  _pos  {0};      // position in the virtual output
+
+public:
+    MetricsWriter(char* buf, size_t from, size_t cap) : _buf(buf), _from(from), _cap(cap) {
+    }
+
+    /// @brief total length of the rendered text
+    size_t length() const {
+        return _pos;
+    }
+
+    /// @brief number of characters stored into the window
+    size_t stored() const {
+        if (_pos <= _from) return 0;
+        return (_pos - _from < _cap) ? _pos - _from : _cap;
+    }
+
+    void put(const char* s, size_t len) {
+        for (size_t i = 0; i < len; i++, _pos++) {
+            if (_pos >= _from && _pos - _from < _cap) _buf[_pos - _from] = s[i];
+        }
+    }
+
+    void put(const char* s) {
+        put(s, strlen(s));
+    }
+
+    void put(uint32_t v) {
+        char tmp[12];
+        put(tmp, snprintf(tmp, sizeof(tmp), "%u", (unsigned) v));
+    }
+
+    /// @brief # TYPE line
+    void type(const char* name, const char* type) {
+        put("# TYPE ");
+        put(name);
+        put(" ");
+        put(type);
+        put("\n");
+    }
+
+    /// @brief name{labels} value
+    void sample(const char* name, const char* labels, uint32_t v) {
+        put(name);
+        if (labels) {
+            put("{");
+            put(labels);
+            put("}");
+        }
+        put(" ");
+        put(v);
+        put("\n");
+    }
+
+    /// @brief counter or gauge with its TYPE line
+    void metric(const char* name, const char* type, uint32_t v) {
+        this->type(name, type);
+        sample(name, nullptr, v);
+    }
+};
+
+/**
+ * @brief all counters of the device, see metrics()
+ *
+ */
+class Metrics {
+public:
+    // ISC messages counted per id, anything else goes to the last "other" cell
+    static const uint8_t iscTypes = 24;
+    static constexpr uint16_t iscIds[iscTypes] = {
+        ISC_ERROR_IND, ISC_TEST_REQ, ISC_TEST_RESP, ISC_VERSION_REQ, ISC_VERSION_RESP, ISC_MSG_BLOCKED_RESP,
+        ISC_AUDIO_CONFIG_REQ, ISC_AUDIO_CONFIG_RESP, ISC_AUDIO_VOLUME_REQ, ISC_AUDIO_VOLUME_RESP,
+        ISC_AUDIO_MUTE_REQ, ISC_AUDIO_MUTE_RESP, ISC_TTS_CONFIG_REQ, ISC_TTS_CONFIG_RESP,
+        ISC_TTS_SPEAK_REQ, ISC_TTS_SPEAK_RESP, ISC_TTS_STOP_REQ, ISC_TTS_STOP_RESP,
+        ISC_TTS_READY_IND, ISC_TTS_FINISHED_IND,
+        ISC_BOOT_LOAD_REQ, ISC_BOOT_LOAD_RESP, ISC_BOOT_RUN_REQ, ISC_BOOT_RUN_RESP };
+
+    // utterances
+    Counter     accepted;
+    Counter     spoken;
+    Counter     dropped;
+
+    // S1V30120
+    Counter     spiSent;
+    Counter     spiReceived;
+    Counter     iscSent[iscTypes + 1];
+    Counter     iscReceived[iscTypes + 1];
+    Counter     chipErrors;
+    Histogram   rdyWait;
+    Histogram   speakLatency;
+    Histogram   responseLatency;
+    Counter     chipRecoveries;                     // successful re-initializations
+    std::atomic<uint32_t> chipRecovery {0};         // duration of the last recovery [us]
+    Counter     uploadBlockRetries;                 // firmware blocks sent again
+    Counter     uploadRestarts;                     // firmware uploads restarted after reset
+
+    // tasks
+    Histogram   tickJitter;             // deviation of the periodic task wake-up
+
+    // wifi
+    Counter     wifiDirected;           // associations to the cached AP
+    Counter     wifiScanned;            // associations after the full scan
+    std::atomic<uint32_t> wifiAssociation {0};  // last connect to IP [us]
+    Counter     wifiLost;               // connection lost
+
+    /// @brief index of the ISC message id into iscSent/iscReceived
+    static uint8_t iscIndex(uint16_t id) {
+        uint8_t i = 0;
+        while (i < iscTypes && iscIds[i] != id) i++;
+        return i;
+    }
+
+    /**
+     * @brief consistent copy of the values for one scrape
+     *
+     */
+    struct Snapshot {
+        uint32_t accepted, spoken, dropped;
+        uint32_t spiSent, spiReceived, chipErrors;
+        uint32_t chipRecoveries, chipRecovery;
+        uint32_t uploadBlockRetries, uploadRestarts;
+        uint32_t iscSent[iscTypes + 1];
+        uint32_t iscReceived[iscTypes + 1];
+        Histogram::Values rdyWait;
+        Histogram::Values speakLatency;
+        Histogram::Values responseLatency;
+        Histogram::Values tickJitter;
+        uint32_t wifiDirected, wifiScanned, wifiAssociation, wifiLost;
+    };
+
+    void snapshot(Snapshot& s) const {
+        s.accepted = accepted.value();
+        s.spoken = spoken.value();
+        s.dropped = dropped.value();
+        s.spiSent = spiSent.value();
+        s.spiReceived = spiReceived.value();
+        s.chipErrors = chipErrors.value();
+        s.chipRecoveries = chipRecoveries.value();
+        s.chipRecovery = chipRecovery.load(std::memory_order_relaxed);
+        s.uploadBlockRetries = uploadBlockRetries.value();
+        s.uploadRestarts = uploadRestarts.value();
+        for (uint8_t i = 0; i <= iscTypes; i++) {
+            s.iscSent[i] = iscSent[i].value();
+            s.iscReceived[i] = iscReceived[i].value();
+        }
+        rdyWait.copy(s.rdyWait);
+        speakLatency.copy(s.speakLatency);
+        responseLatency.copy(s.responseLatency);
+        tickJitter.copy(s.tickJitter);
+        s.wifiDirected = wifiDirected.value();
+        s.wifiScanned = wifiScanned.value();
+        s.wifiAssociation = wifiAssociation.load(std::memory_order_relaxed);
+        s.wifiLost = wifiLost.value();
+    }
+
+    static void render(const Snapshot& s, MetricsWriter& w) {
+        w.type("dectalk_utterances_total", "counter");
+        w.sample("dectalk_utterances_total", "state=\"accepted\"", s.accepted);
+        w.sample("dectalk_utterances_total", "state=\"spoken\"", s.spoken);
+        w.sample("dectalk_utterances_total", "state=\"dropped\"", s.dropped);
+
+        w.type("dectalk_spi_bytes_total", "counter");
+        w.sample("dectalk_spi_bytes_total", "dir=\"tx\"", s.spiSent);
+        w.sample("dectalk_spi_bytes_total", "dir=\"rx\"", s.spiReceived);
+
+        w.metric("dectalk_chip_errors_total", "counter", s.chipErrors);
+        w.metric("dectalk_chip_recoveries_total", "counter", s.chipRecoveries);
+        w.type("dectalk_chip_recovery_seconds", "gauge");
+        seconds(w, "dectalk_chip_recovery_seconds", s.chipRecovery);
+        w.type("dectalk_chip_upload_retries_total", "counter");
+        w.sample("dectalk_chip_upload_retries_total", "scope=\"block\"", s.uploadBlockRetries);
+        w.sample("dectalk_chip_upload_retries_total", "scope=\"image\"", s.uploadRestarts);
+
+        w.type("dectalk_isc_messages_total", "counter");
+        isc(w, "tx", s.iscSent);
+        isc(w, "rx", s.iscReceived);
+
+        histogram(w, "dectalk_rdy_wait_seconds", s.rdyWait);
+        histogram(w, "dectalk_speak_seconds", s.speakLatency);
+        histogram(w, "dectalk_response_seconds", s.responseLatency);
+        histogram(w, "dectalk_tick_jitter_seconds", s.tickJitter);
+
+        w.type("dectalk_wifi_connects_total", "counter");
+        w.sample("dectalk_wifi_connects_total", "mode=\"directed\"", s.wifiDirected);
+        w.sample("dectalk_wifi_connects_total", "mode=\"scan\"", s.wifiScanned);
+        w.type("dectalk_wifi_association_seconds", "gauge");
+        seconds(w, "dectalk_wifi_association_seconds", s.wifiAssociation);
+        w.metric("dectalk_wifi_lost_total", "counter", s.wifiLost);
+    }
+
+private:
+
+    static void isc(MetricsWriter& w, const char* dir, const uint32_t* values) {
+        char labels[32];
+        for (uint8_t i = 0; i <= iscTypes; i++) {
+            if (values[i] == 0) continue;
+            if (i < iscTypes) snprintf(labels, sizeof(labels), "dir=\"%s\",msg=\"0x%04X\"", dir, iscIds[i]);
+            else snprintf(labels, sizeof(labels), "dir=\"%s\",msg=\"other\"", dir);
+            w.sample("dectalk_isc_messages_total", labels, values[i]);
+        }
+    }
+
+    /// @brief sample in seconds with microsecond resolution
+    static void seconds(MetricsWriter& w, const char* name, uint64_t us) {
+        char value[32];
+        w.put(name);
+        w.put(value, snprintf(value, sizeof(value), " %llu.%06u\n", (unsigned long long) (us / 1000000), (unsigned) (us % 1000000)));
+    }
+
+    static void histogram(MetricsWriter& w, const char* name, const Histogram::Values& values) {
+        char labels[24];
+        char sample[48];
+        uint32_t cumulative = 0;
+        w.type(name, "histogram");
+        for (uint8_t i = 0; i <= Histogram::buckets; i++) {
+            cumulative += values.count[i];
+            snprintf(labels, sizeof(labels), "le=\"%s\"", i < Histogram::buckets ? Histogram::labels[i] : "+Inf");
+            snprintf(sample, sizeof(sample), "%s_bucket", name);
+            w.sample(sample, labels, cumulative);
+        }
+
+        snprintf(sample, sizeof(sample), "%s_sum", name);
+        seconds(w, sample, values.sum);
+        snprintf(sample, sizeof(sample), "%s_count", name);
+        w.sample(sample, nullptr, cumulative);
+    }
+};
+
+/**
+ * @brief the device wide metrics
+ *
+ * @return Metrics&
+ */
+inline Metrics& metrics() {
+    static Metrics m;
+    return m;
+}
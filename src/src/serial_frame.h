@@ -0,0 +1,384 @@
+/**
+ * @file serial_frame.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Binary serial protocol - SLIP framing, CRC-16, commands & acknowledgements
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+#include "S1V30120.h"
+#include "talk_queue.h"
+#include "synth_pool.h"
+
+/**
+ * @brief lookup table of Crc16, built by the compiler
+ *
+ */
+struct Crc16Table {
+    uint16_t v[256];
+    constexpr Crc16Table() : v() {
+        for (uint16_t i = 0; i < 256; i++) {
+            uint16_t crc = i << 8;
+            for (uint8_t b = 0; b < 8; b++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+            v[i] = crc;
+        }
+    }
+};
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+ *
+ */
+class Crc16 {
+private:
+    static constexpr Crc16Table _table {};
+
+public:
+    static constexpr uint16_t init = 0xFFFF;
+    static_assert(Crc16Table().v[1] == 0x1021, "CRC-16 table");
+
+    static uint16_t update(uint16_t crc, const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) crc = (crc << 8) ^ _table.v[((crc >> 8) ^ data[i]) & 0xFF];
+        return crc;
+    }
+
+    static uint16_t calc(const uint8_t* data, size_t len) {
+        return update(init, data, len);
+    }
+};
+
+/**
+ * @brief SLIP (RFC 1055) decoder, byte by byte state machine over a fixed buffer
+ *
+ * @tparam Size - maximum decoded frame size
+ */
+template <size_t Size>
+class SlipDecoder {
+public:
+    static const uint8_t end = 0xC0;
+    static const uint8_t esc = 0xDB;
+    static const uint8_t escEnd = 0xDC;
+    static const uint8_t escEsc = 0xDD;
+
+private:
+    uint8_t     _buff[Size];
+    size_t      _len      {0};
+    bool        _escaped  {false};
+    bool        _overflow {false};
+
+public:
+
+    /// @brief one received byte
+    /// @return true - frame complete, see data() / size()
+    bool feed(uint8_t ch) {
+        if (ch == end) {
+            bool rc = _len > 0 && !_overflow;
+            if (!rc) _len = 0;
+            _escaped = false;
+            _overflow = false;
+            return rc;
+        }
+
+        if (_escaped) {
+            _escaped = false;
+            if (ch == escEnd) ch = end;
+            else if (ch == escEsc) ch = esc;
+        } else if (ch == esc) {
+            _escaped = true;
+            return false;
+        }
+
+        if (_len < Size) _buff[_len++] = ch;
+        else _overflow = true;
+        return false;
+    }
+
+    const uint8_t* data() const {
+        return _buff;
+    }
+
+    size_t size() const {
+        return _len;
+    }
+
+    /// @brief start of the next frame, call after the complete frame is processed or to drop a partial one
+    void reset() {
+        _len = 0;
+        _escaped = false;
+        _overflow = false;
+    }
+};
+
+/**
+ * @brief Binary protocol on the serial line, every frame is SLIP encoded
+ * and ends with CRC-16 (little endian) of the preceding bytes:
+ *
+ *   request:  | cmd | seq | payload ... | crc |
+ *   ack:      | 0x80 + cmd | seq | result | id u32 | [status] | crc |
+ *   event:    | 0xA0 | 0 | TalkEvent | id u32 | crc |
+ *
+ * Commands: speak & urgent (text, optional "@zone " prefix), stop (all chips; flags, bit 0 - drop queued),
+ * voice (u8, all chips), rate (u16, words per minute, all chips), volume (i16, dB, all chips), status, text (back to the line editor).
+ * Status ack carries: queue depth u8, free slots u8, ready u8, speaking u8, eta u32 [ms].
+ * All numbers are little endian, nothing is allocated.
+ *
+ * The terminal starts in text mode. A 0xC0 at the start of a line begins a probe,
+ * the binary mode is entered by the first complete frame with a valid CRC. A probe that
+ * fails (invalid frame, too long, no byte for probeIdle) is returned to the line editor,
+ * so a stray 0xC0 (line noise, Latin-1 'A grave') is just text. The binary mode goes back
+ * to text by Cmd::text or after binaryIdle without any byte.
+ *
+ */
+class SerialFrame {
+public:
+    enum class Cmd : uint8_t { speak = 0x01, urgent = 0x02, stop = 0x03, voice = 0x04, rate = 0x05,
+                               volume = 0x06, status = 0x07, text = 0x08 };
+    enum class Result : uint8_t { ok = 0, failed = 1, crc = 2, unknown = 3, length = 4, busy = 5 };
+    enum class Feed : uint8_t { more, frame, text };   ///> text - the probe failed, see replay()
+
+    static const uint8_t ack = 0x80;
+    static const uint8_t event = 0xA0;
+    static const uint8_t nak = 0xFF;        // ack of a frame with invalid CRC
+    static const size_t maxFrame = 2 + S1V30120::maximumMsgSize + 2;
+    static const uint8_t end = SlipDecoder<maxFrame>::end;
+    static const size_t maxProbe = 2 * maxFrame + 3;   // encoded frame, every byte escaped, both ends + 1
+    static const uint32_t probeIdle = 50;              // [ms] typed text is slower
+    static const uint32_t binaryIdle = 60000;          // [ms] silent client, back to the text mode
+
+    using Output = std::function<void(const uint8_t* data, size_t len)>;
+
+private:
+    SlipDecoder<maxFrame>   _decoder;
+    TalkQueue*              _queue  {nullptr};
+    SynthPool*              _synth  {nullptr};
+    Output                  _out;
+    bool                    _active {false};   // binary mode
+    bool                    _probing{false};   // 0xC0 seen, no valid frame yet
+    uint8_t                 _probe[maxProbe];  // raw bytes of the probe, replayed as text
+    size_t                  _probeLen {0};
+    unsigned long           _last   {0};       // last received byte [ms]
+    const char*             _allZones = "all"; // voice & rate are set on all chips
+
+public:
+
+    /**
+     * @brief Construct a new Serial Frame object
+     *
+     * @param queue - queue of utterances
+     * @param synth - chips, stop & volume
+     */
+    explicit SerialFrame(TalkQueue* queue, SynthPool* synth) : _queue(queue), _synth(synth) {
+    }
+
+    /**
+     * @brief output of the encoded frames and event subscription
+     *
+     * @param out - writes one whole frame at once
+     * @return true - success
+     * @return false - no free queue listener
+     */
+    bool init(Output out) {
+        _out = out;
+        return _queue->addListener([this] (TalkEvent ev, uint32_t id) {
+            if (!_active) return;
+            uint8_t frame[7] = { event, 0, static_cast<uint8_t>(ev) };
+            put32(&frame[3], id);
+            send(frame, sizeof(frame));
+        });
+    }
+
+    /// @brief binary mode, entered by the first valid frame, left by Cmd::text or binaryIdle
+    bool isActive() const {
+        return _active;
+    }
+
+    /// @brief the bytes go to feed() until the probe is decided
+    bool isProbing() const {
+        return _probing;
+    }
+
+    /**
+     * @brief one received byte, in the binary mode or in the probe
+     *
+     * @param ch - byte
+     * @return Feed::frame - end of frame
+     * @return Feed::text - not a frame, replay() the probe as text
+     */
+    Feed feed(uint8_t ch) {
+        _last = millis();
+        if (!_active) {
+            if (!_probing) {
+                _probing = true;
+                _probeLen = 0;
+                _decoder.reset();
+            }
+            _probe[_probeLen++] = ch;
+            if (_probeLen == maxProbe) return fail();
+        }
+
+        if (!_decoder.feed(ch)) return Feed::more;
+        auto data = _decoder.data();
+        auto len = _decoder.size();
+        _decoder.reset();
+        if (_probing) {
+            if (!isValid(data, len)) return fail();
+            _probing = false;
+            _active = true;
+        }
+        process(data, len);
+        return Feed::frame;
+    }
+
+    /**
+     * @brief timeouts without any byte, call periodically
+     *
+     * @return Feed::text - the probe expired, replay() it as text
+     */
+    Feed idle() {
+        auto silent = millis() - _last;
+        if (_probing && silent > probeIdle) return fail();
+        if (_active && silent > binaryIdle) _active = false;
+        return Feed::more;
+    }
+
+    /**
+     * @brief bytes of the failed probe
+     *
+     * @param len - number of bytes
+     * @return const uint8_t* - valid until the next feed()
+     */
+    const uint8_t* replay(size_t& len) const {
+        len = _probeLen;
+        return _probe;
+    }
+
+private:
+
+    static void put32(uint8_t* p, uint32_t v) {
+        p[0] = v & 0xFF;
+        p[1] = (v >> 8) & 0xFF;
+        p[2] = (v >> 16) & 0xFF;
+        p[3] = (v >> 24) & 0xFF;
+    }
+
+    /// @brief end of the probe, the bytes are text
+    Feed fail() {
+        _probing = false;
+        _decoder.reset();
+        return Feed::text;
+    }
+
+    /// @brief frame with a valid CRC
+    static bool isValid(const uint8_t* data, size_t len) {
+        return len >= 4 && Crc16::calc(data, len - 2) == (data[len - 2] | (data[len - 1] << 8));
+    }
+
+    /// @brief one decoded frame
+    void process(const uint8_t* data, size_t len) {
+        if (len < 4) return;        // noise between frames
+
+        len -= 2;
+        uint8_t cmd = data[0];
+        uint8_t seq = data[1];
+        if (Crc16::calc(data, len) != (data[len] | (data[len + 1] << 8))) {
+            reply(nak, seq, Result::crc, 0);
+            return;
+        }
+
+        const uint8_t* payload = data + 2;
+        size_t size = len - 2;
+        uint32_t id = 0;
+        Result rc = Result::ok;
+        char txt[24];
+
+        switch (static_cast<Cmd>(cmd)) {
+            case Cmd::speak:
+            case Cmd::urgent:
+                if (size == 0 || size > S1V30120::maximumMsgSize) rc = Result::length;
+                else if (!_queue->push(reinterpret_cast<const char*>(payload), size, &id, static_cast<Cmd>(cmd) == Cmd::urgent)) rc = Result::busy;
+                break;
+
+            case Cmd::stop:
+                if (size > 0 && (payload[0] & 0x01)) _queue->clear();
+                if (!_synth->stop()) rc = Result::failed;
+                break;
+
+            case Cmd::voice:
+                if (size != 1) rc = Result::length;
+                else if (!_queue->push(txt, snprintf(txt, sizeof(txt), "[:name %u]", payload[0]), &id, false, _allZones)) rc = Result::busy;
+                break;
+
+            case Cmd::rate:
+                if (size != 2) rc = Result::length;
+                else if (!_queue->push(txt, snprintf(txt, sizeof(txt), "[:rate %u]", payload[0] | (payload[1] << 8)), &id, false, _allZones)) rc = Result::busy;
+                break;
+
+            case Cmd::volume:
+                if (size != 2) rc = Result::length;
+                else if (!_synth->setVolume(static_cast<int16_t>(payload[0] | (payload[1] << 8)))) rc = Result::failed;
+                break;
+
+            case Cmd::status:
+                status(seq);
+                return;
+
+            case Cmd::text:
+                reply(ack | cmd, seq, Result::ok, 0);
+                _active = false;
+                return;
+
+            default:
+                rc = Result::unknown;
+                break;
+        }
+        reply(ack | cmd, seq, rc, id);
+    }
+
+    void reply(uint8_t type, uint8_t seq, Result rc, uint32_t id) {
+        uint8_t frame[7] = { type, seq, static_cast<uint8_t>(rc) };
+        put32(&frame[3], id);
+        send(frame, sizeof(frame));
+    }
+
+    void status(uint8_t seq) {
+        uint8_t frame[15] = { ack | static_cast<uint8_t>(Cmd::status), seq, static_cast<uint8_t>(Result::ok) };
+        put32(&frame[3], 0);
+        frame[7] = _queue->size();
+        frame[8] = _queue->available();
+        frame[9] = _synth->isReady();
+        frame[10] = _synth->isRunning();
+        put32(&frame[11], _queue->eta());
+        send(frame, sizeof(frame));
+    }
+
+    /// @brief SLIP encoded frame with CRC, written at once
+    void send(const uint8_t* data, size_t len) {
+        uint8_t out[2 * (16 + 2) + 2];
+        size_t n = 0;
+        uint16_t crc = Crc16::calc(data, len);
+        const uint8_t tail[2] = { static_cast<uint8_t>(crc & 0xFF), static_cast<uint8_t>(crc >> 8) };
+
+        out[n++] = end;
+        for (size_t i = 0; i < len + 2; i++) {
+            uint8_t ch = i < len ? data[i] : tail[i - len];
+            if (ch == end) {
+                out[n++] = SlipDecoder<maxFrame>::esc;
+                out[n++] = SlipDecoder<maxFrame>::escEnd;
+            } else if (ch == SlipDecoder<maxFrame>::esc) {
+                out[n++] = SlipDecoder<maxFrame>::esc;
+                out[n++] = SlipDecoder<maxFrame>::escEsc;
+            } else {
+                out[n++] = ch;
+            }
+        }
+        out[n++] = end;
+        if (_out) _out(out, n);
+    }
+};
@@ -0,0 +1,391 @@
+/**
+ * @file serial_ingest.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Non blocking serial terminal - line editor, queued lines & buffered output
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <HardwareSerial.h>
+#include <mutex>
+#include <functional>
+#include "talk_queue.h"
+#include "talk_stream.h"
+#include "serial_frame.h"
+
+/**
+ * @brief handler of the special lines (e.g. "#trace")
+ *
+ * @return true - line consumed, not spoken
+ */
+using SerialCommand = std::function<bool(const char* line, size_t len)>;
+
+/**
+ * @brief Serial terminal that never blocks. The UART driver keeps the received bytes in
+ * its ring buffer and wakes the owner task from the UART event task (onReceive).
+ * The owner task edits the line and pushes every completed line into TalkQueue,
+ * so the text typed while the device speaks is kept. A line longer than one utterance
+ * is split at a word boundary and goes on through TalkStream, nothing is lost.
+ * Echo and all other output go through a ring buffer drained as the UART
+ * accepts data, output that does not fit is dropped and counted.
+ *
+ * A SLIP frame (0xC0) with a valid CRC at the start of a line switches to the binary protocol,
+ * see SerialFrame. In the binary mode the text output is suppressed.
+ *
+ * Flow control stops the sender when only highWatermark slots of the queue are free
+ * and resumes it at lowWatermark. The terminal stops reading, the unread bytes stay
+ * in the UART ring buffer, which absorbs the sender's overshoot:
+ *  - rtscts  - the full UART FIFO deasserts RTS in hardware
+ *  - xonxoff - XOFF / XON are sent immediately, bypassing the output ring
+ *
+ */
+class SerialIngest : public Print {
+public:
+    static const size_t rxBufferSize = 1024;
+    static const size_t txBufferSize = 1024;
+    static const uint8_t baudRates = 8;
+    static constexpr uint32_t bauds[baudRates] = { 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600 };
+    static const uint32_t defaultBaud = 9600;
+
+    enum class FlowControl : uint8_t { none, xonxoff, rtscts };
+    static const uint8_t xon = 0x11;
+    static const uint8_t xoff = 0x13;
+    static const uint8_t highWatermark = 4;                     // free slots, sender stopped
+    static const uint8_t lowWatermark = TalkQueue::capacity / 2; // free slots, sender resumed
+
+private:
+    HardwareSerial*     _serial {nullptr};
+    TalkQueue*          _queue  {nullptr};
+    TaskHandle_t        _task   {nullptr};      // owner task, woken by the UART
+    SerialCommand       _command;
+    SerialFrame*        _frames {nullptr};      // binary protocol, optional
+    FlowControl         _flow   {FlowControl::none};
+    bool                _hold   {false};        // sender stopped, input not read
+
+    // line editor
+    char                _line[S1V30120::maximumMsgSize + 1];
+    uint16_t            _len    {0};
+    char                _prev   {0};            // CR LF is one end of line
+    TalkStream          _stream {nullptr};      // line longer than one utterance
+    bool                _split  {false};        // the line goes through _stream
+
+    // output
+    std::mutex          _mtx;                   // output ring, written from any task
+    uint8_t             _tx[txBufferSize];
+    size_t              _txHead {0};
+    size_t              _txCount{0};
+    uint32_t            _txDropped{0};
+
+    const char*         _limitstr = "limit error";
+    const TickType_t    _poll = pdMS_TO_TICKS(100);  // output drain without any input
+
+public:
+
+    /**
+     * @brief Construct a new Serial Ingest object
+     *
+     * @param serial - UART
+     * @param queue - queue of utterances
+     */
+    explicit SerialIngest(HardwareSerial* serial, TalkQueue* queue) : _serial(serial), _queue(queue) {
+    }
+
+    /**
+     * @brief supported baud rate or the default one
+     *
+     * @param baud - requested baud rate
+     * @return uint32_t
+     */
+    static uint32_t validBaud(uint32_t baud) {
+        for (auto b : bauds) {
+            if (b == baud) return baud;
+        }
+        return defaultBaud;
+    }
+
+    /**
+     * @brief supported flow control or none
+     *
+     * @param flow - stored value
+     * @return FlowControl
+     */
+    static FlowControl validFlow(int32_t flow) {
+        if (flow < 0 || flow > static_cast<int32_t>(FlowControl::rtscts)) return FlowControl::none;
+        return static_cast<FlowControl>(flow);
+    }
+
+    /**
+     * @brief restart the UART with the receive ring buffer, call before the other tasks print
+     *
+     * @param baud - baud rate, see bauds
+     * @param flow - flow control
+     * @param rtsPin - RTS output, rtscts only
+     * @param ctsPin - CTS input, rtscts only
+     * @return true - success
+     * @return false
+     */
+    bool init(uint32_t baud = defaultBaud, FlowControl flow = FlowControl::none, int8_t rtsPin = -1, int8_t ctsPin = -1) {
+        bool rc = false;
+        do {
+            if (!_serial || !_queue) break;
+            _serial->flush();
+            _serial->end();
+            _serial->setRxBufferSize(rxBufferSize);
+            _serial->begin(validBaud(baud));
+            _serial->onReceive([this] () {
+                if (_task) xTaskNotifyGive(_task);
+            });
+
+            _flow = flow;
+            if (_flow == FlowControl::rtscts) {
+                if (!_serial->setPins(-1, -1, ctsPin, rtsPin)) break;
+                if (!_serial->setHwFlowCtrlMode()) break;
+            }
+
+            // a slot was freed, the held sender may continue
+            if (_flow != FlowControl::none && !_queue->addListener([this] (TalkEvent ev, uint32_t) {
+                    if (ev == TalkEvent::started && _hold && _task) xTaskNotifyGive(_task);
+                })) break;
+            rc = true;
+        } while (false);
+        return rc;
+    }
+
+    /**
+     * @brief handler of the special lines, call before run()
+     *
+     * @param command
+     */
+    void setCommand(SerialCommand command) {
+        _command = command;
+    }
+
+    /**
+     * @brief enable the binary protocol, call before run()
+     *
+     * @param frames - protocol
+     * @return true - success
+     */
+    bool setFrames(SerialFrame* frames) {
+        _frames = frames;
+        return _frames->init([this] (const uint8_t* data, size_t len) {
+            store(data, len, true);
+        });
+    }
+
+    /**
+     * @brief body of the owner task, never returns
+     *
+     */
+    void run() {
+        _task = xTaskGetCurrentTaskHandle();
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, _poll);
+            update();
+        }
+    }
+
+    /**
+     * @brief process the received bytes and send the buffered output
+     *
+     */
+    void update() {
+        backpressure();
+        while (!_hold && _serial->available() > 0) {
+            char ch = _serial->read();
+            if (_frames && (binary() || _frames->isProbing() || (_len == 0 && static_cast<uint8_t>(ch) == SerialFrame::end))) {
+                auto fed = _frames->feed(ch);
+                if (fed == SerialFrame::Feed::frame) backpressure();
+                else if (fed == SerialFrame::Feed::text) replay();
+                continue;
+            }
+            if (text(ch)) backpressure();
+        }
+        if (_frames && _frames->idle() == SerialFrame::Feed::text) replay();
+        drain(false);
+    }
+
+    /// @brief sender is stopped by the flow control
+    bool isHeld() const {
+        return _hold;
+    }
+
+    /**
+     * @brief send all buffered output, blocks
+     *
+     */
+    void flush() {
+        drain(true);
+    }
+
+    /// @brief output dropped because the ring was full
+    uint32_t dropped() const {
+        return _txDropped;
+    }
+
+    size_t write(uint8_t ch) override {
+        return write(&ch, 1);
+    }
+
+    /// @brief buffered text output, never blocks, suppressed in the binary mode
+    size_t write(const uint8_t* data, size_t len) override {
+        if (!binary()) store(data, len, false);
+        return len;
+    }
+
+private:
+
+    /// @brief binary protocol active
+    bool binary() const {
+        return _frames && _frames->isActive();
+    }
+
+    /// @brief into the output ring
+    /// @param whole - true - all or nothing (frame)
+    void store(const uint8_t* data, size_t len, bool whole) {
+        size_t stored = 0;
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            if (!whole || txBufferSize - _txCount >= len) {
+                while (stored < len && _txCount < txBufferSize) {
+                    _tx[(_txHead + _txCount) % txBufferSize] = data[stored++];
+                    _txCount++;
+                }
+            }
+            _txDropped += len - stored;
+        }
+        if (_task && _task != xTaskGetCurrentTaskHandle()) xTaskNotifyGive(_task);
+    }
+
+    /// @brief stop / resume the sender by the free slots of the queue
+    /// XON/XOFF would corrupt the binary frames, the binary client relies on the acks there.
+    void backpressure() {
+        if (_flow == FlowControl::none) return;
+        if (_flow == FlowControl::xonxoff && binary()) return;
+        auto free = _queue->available();
+        if (!_hold && free <= highWatermark) {
+            _hold = true;
+            if (_flow == FlowControl::xonxoff) _serial->write(xoff);
+        } else if (_hold && free >= lowWatermark) {
+            _hold = false;
+            if (_flow == FlowControl::xonxoff) _serial->write(xon);
+        }
+    }
+
+    /// @brief text character, the flow control ones are not text
+    /// @return true - end of line
+    bool text(char ch) {
+        if (_flow == FlowControl::xonxoff && (ch == xon || ch == xoff)) return false;
+        return edit(ch);
+    }
+
+    /// @brief the bytes of a failed binary probe into the line editor
+    void replay() {
+        size_t len = 0;
+        auto data = _frames->replay(len);
+        for (size_t i = 0; i < len; i++) {
+            if (text(static_cast<char>(data[i]))) backpressure();
+        }
+    }
+
+    /// @brief line editor, one received character
+    /// @return true - end of line
+    bool edit(char ch) {
+        auto prev = _prev;
+        _prev = ch;
+
+        if (ch == '\n' && prev == '\r') return false;
+        if (ch == '\r' || ch == '\n') {
+            print("\r\n");
+            complete();
+            return true;
+        }
+
+        if (ch == 8 || ch == 127) {
+            // backspace
+            if (_len > 0) {
+                _len--;
+                print("\b \b");
+            }
+            return false;
+        }
+
+        // maximum message size reached, the beginning goes on as an utterance
+        auto split = _len >= S1V30120::maximumMsgSize;
+        if (split) cut();
+
+        _line[_len++] = ch;
+        write(static_cast<uint8_t>(ch));
+        return split;
+    }
+
+    /// @brief the full line up to its last word boundary into the stream, the rest stays for editing
+    void cut() {
+        uint16_t n = _len;
+        while (n > 0 && !isBoundary(_line[n - 1])) n--;
+        if (n == 0) n = _len;
+
+        if (!_split) {
+            _stream = TalkStream(_queue);
+            _split = true;
+        }
+        _stream.feed(reinterpret_cast<const uint8_t*>(_line), n);
+        _len -= n;
+        memmove(_line, _line + n, _len);
+    }
+
+    /// @brief word boundary, the same as TalkStream's
+    static bool isBoundary(char ch) {
+        return ch == ' ' || ch == '.' || ch == ',' || ch == ';' || ch == '!' || ch == '?';
+    }
+
+    /// @brief end of line
+    void complete() {
+        auto len = _len;
+        _len = 0;
+        if (_split) {
+            _split = false;
+            _stream.feed(reinterpret_cast<const uint8_t*>(_line), len);
+            if (!_stream.finish()) println(_limitstr);
+            return;
+        }
+        if (len == 0) return;
+        _line[len] = 0;
+
+        if (_command) {
+            drain(true);
+            if (_command(_line, len)) return;
+        }
+        if (!_queue->push(_line, len)) println(_limitstr);
+    }
+
+    /// @brief move output ring into the UART
+    /// @param wait - true - until everything is sent
+    void drain(bool wait) {
+        while (true) {
+            std::unique_lock<std::mutex> lck(_mtx);
+            if (_txCount == 0) break;
+            size_t len = _txCount;
+            if (_txHead + len > txBufferSize) len = txBufferSize - _txHead;
+            if (!wait) {
+                int room = _serial->availableForWrite();
+                if (room <= 0) break;
+                if (len > (size_t) room) len = room;
+            }
+            // copy out, the UART may block in wait mode and writers must not
+            uint8_t chunk[64];
+            if (len > sizeof(chunk)) len = sizeof(chunk);
+            memcpy(chunk, &_tx[_txHead], len);
+            _txHead = (_txHead + len) % txBufferSize;
+            _txCount -= len;
+            lck.unlock();
+            _serial->write(chunk, len);
+        }
+    }
+};
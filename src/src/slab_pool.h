@@ -0,0 +1,159 @@
+/**
+ * @file slab_pool.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Fixed arena of slabs for the short lived buffers, no heap
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <mutex>
+#include "metrics.h"
+
+/**
+ * @brief occupancy of one class
+ *
+ */
+struct SlabStats {
+    uint8_t     used;           // slots taken now
+    uint8_t     peak;           // most slots ever taken
+    uint32_t    exhausted;      // requests of the class not served
+};
+
+/**
+ * @brief occupancy of all classes, does not depend on the slot sizes,
+ * so the object kept in a slot may contain it
+ *
+ * @tparam Classes - number of classes
+ */
+template <uint8_t Classes>
+struct SlabSnapshot {
+    SlabStats   cls[Classes];
+};
+
+/**
+ * @brief slot size of an object, 8 byte aligned
+ *
+ * @param size - sizeof of the object
+ * @return constexpr uint16_t
+ */
+constexpr uint16_t slabSize(size_t size) {
+    return static_cast<uint16_t>((size + 7) & ~static_cast<size_t>(7));
+}
+
+/**
+ * @brief Static arena split into size classes, one class per kind of object kept in it,
+ * sized by its sizeof. A class keeps its free slots on a stack, alloc and release are O(1).
+ * A request takes the smallest class that fits and spills into a larger one
+ * when its own class is empty. Nothing fragments the heap of a long running unit,
+ * an exhausted pool returns nullptr and the caller rejects the work (503).
+ *
+ * @tparam Layout - static constexpr classes, sizes[classes] ascending, counts[classes]
+ */
+template <class Layout>
+class SlabPool {
+public:
+    static constexpr uint8_t classes = Layout::classes;
+    static const uint8_t maxCount = 8;
+    using Snapshot = SlabSnapshot<classes>;
+
+private:
+    /// @brief arena offset of the first slot of the class
+    static constexpr size_t offset(uint8_t c) {
+        return c == 0 ? 0 : offset(c - 1) + Layout::sizes[c - 1] * Layout::counts[c - 1];
+    }
+    static constexpr size_t arenaSize = offset(classes);
+
+    /// @brief sizes ascending & 8 byte aligned, counts within the stacks
+    static constexpr bool isValid(uint8_t c = 0) {
+        return c == classes ||
+               (Layout::sizes[c] % 8 == 0 && Layout::counts[c] > 0 && Layout::counts[c] <= maxCount &&
+                (c == 0 || Layout::sizes[c - 1] < Layout::sizes[c]) && isValid(c + 1));
+    }
+    static_assert(isValid(), "slab classes - ascending 8 byte aligned sizes, 1 .. maxCount slots");
+
+    std::mutex  _mtx;
+    alignas(8) uint8_t _arena[arenaSize];
+    uint8_t     _free[classes][maxCount];       // stacks of free slot indices
+    uint8_t     _top[classes];                  // number of free slots
+    SlabStats   _stats[classes] {};
+
+public:
+    SlabPool() {
+        for (uint8_t c = 0; c < classes; c++) {
+            _top[c] = Layout::counts[c];
+            for (uint8_t i = 0; i < Layout::counts[c]; i++) _free[c][i] = Layout::counts[c] - 1 - i;
+        }
+    }
+
+    /**
+     * @brief take a slot
+     *
+     * @param size - bytes needed
+     * @return void* - slot aligned to 8 bytes, nullptr - too large or exhausted
+     */
+    void* alloc(size_t size) {
+        uint8_t c = 0;
+        while (c < classes && Layout::sizes[c] < size) c++;
+        if (c == classes) return nullptr;
+
+        std::lock_guard<std::mutex> lck(_mtx);
+        for (uint8_t k = c; k < classes; k++) {
+            if (_top[k] == 0) continue;
+            auto i = _free[k][--_top[k]];
+            auto& st = _stats[k];
+            if (++st.used > st.peak) st.peak = st.used;
+            return _arena + offset(k) + i * Layout::sizes[k];
+        }
+        _stats[c].exhausted++;
+        return nullptr;
+    }
+
+    /**
+     * @brief return a slot
+     *
+     * @param ptr - slot from alloc(), nullptr is ignored
+     * @return true - returned
+     * @return false - not a slot of this pool
+     */
+    bool release(void* ptr) {
+        auto p = static_cast<uint8_t*>(ptr);
+        if (p < _arena || p >= _arena + arenaSize) return false;
+        size_t off = p - _arena;
+        uint8_t c = 0;
+        while (off >= offset(c + 1)) c++;
+
+        std::lock_guard<std::mutex> lck(_mtx);
+        _free[c][_top[c]++] = (off - offset(c)) / Layout::sizes[c];
+        _stats[c].used--;
+        return true;
+    }
+
+    void snapshot(Snapshot& s) {
+        std::lock_guard<std::mutex> lck(_mtx);
+        for (uint8_t c = 0; c < classes; c++) s.cls[c] = _stats[c];
+    }
+
+    static void render(const Snapshot& s, MetricsWriter& w) {
+        char labels[32];
+        w.type("dectalk_pool_slots", "gauge");
+        for (uint8_t c = 0; c < classes; c++) {
+            snprintf(labels, sizeof(labels), "class=\"%u\",state=\"used\"", (unsigned) Layout::sizes[c]);
+            w.sample("dectalk_pool_slots", labels, s.cls[c].used);
+            snprintf(labels, sizeof(labels), "class=\"%u\",state=\"peak\"", (unsigned) Layout::sizes[c]);
+            w.sample("dectalk_pool_slots", labels, s.cls[c].peak);
+            snprintf(labels, sizeof(labels), "class=\"%u\",state=\"total\"", (unsigned) Layout::sizes[c]);
+            w.sample("dectalk_pool_slots", labels, Layout::counts[c]);
+        }
+        w.type("dectalk_pool_exhausted_total", "counter");
+        for (uint8_t c = 0; c < classes; c++) {
+            snprintf(labels, sizeof(labels), "class=\"%u\"", (unsigned) Layout::sizes[c]);
+            w.sample("dectalk_pool_exhausted_total", labels, s.cls[c].exhausted);
+        }
+    }
+};
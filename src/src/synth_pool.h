@@ -0,0 +1,287 @@
+/**
+ * @file synth_pool.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief S1V30120 chips sharing one SPI bus, one synthesizer task per chip
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include "S1V30120.h"
+#include "talk_queue.h"
+
+/**
+ * @brief one chip and the utterance it speaks, owned by its synthesizer task.
+ * The other tasks never touch the chip, they post a command the task executes.
+ *
+ */
+struct Voice {
+    enum class Command : uint8_t { none, stop, volume };
+
+    S1V30120*   chip    {nullptr};
+    uint8_t     index   {0};
+    bool        failed  {false};    ///> recovery failed repeatedly, reported
+    TaskHandle_t task   {nullptr};  ///> synthesizer task, woken up by a command
+    Utterance   utterance;
+
+    std::atomic<uint32_t> request {0};  ///> posted command: sequence << 8 | Command
+    std::atomic<uint32_t> reply   {0};  ///> executed command: sequence << 8 | 1 - success, 0 - failed
+    std::atomic<int16_t>  volume  {0};  ///> argument of Command::volume
+};
+
+/**
+ * @brief All chips on the bus. The synthesizer tasks take the utterances from
+ * one TalkQueue, so an utterance goes to whichever chip is idle first.
+ * The copies of a broadcast wait for each other and start together.
+ * The commands from the clients (stop, volume) apply to all chips, they are
+ * executed by the synthesizer tasks (serve()), so only core 1 drives the chips.
+ *
+ */
+class SynthPool {
+public:
+    static const uint8_t maxChips = TalkQueue::maxConsumers;
+    static const uint32_t commandTimeout = 2000;   // longest wait for the synthesizer tasks [ms]
+
+private:
+    Voice                   _voices[maxChips];
+    uint8_t                 _count    {0};
+    std::atomic<uint8_t>    _speaking {0};
+
+    // one command at a time, posted to all chips
+    std::mutex              _cmdMtx;
+    uint32_t                _sequence {0};
+
+    // broadcast in progress, the next one can not start before all chips took this one
+    std::mutex              _mtx;
+    uint32_t                _arrivedId  {0};
+    uint8_t                 _arrived    {0};
+    uint8_t                 _missing    {0};    // withdrawn copies
+    bool                    _open       {false}; // start not reported yet
+    uint32_t                _finishedId {0};
+    uint8_t                 _finished   {0};
+
+public:
+
+    /**
+     * @brief add a chip, call before the synthesizer tasks start
+     *
+     * @param chip - driver
+     * @return Voice* - state of the chip, the argument of its task, nullptr - no free slot
+     */
+    Voice* add(S1V30120* chip) {
+        if (!chip || _count >= maxChips) return nullptr;
+        auto& v = _voices[_count];
+        v.chip = chip;
+        v.index = _count++;
+        return &v;
+    }
+
+    /**
+     * @brief synthesizer task of the chip, call before the commands can come
+     *
+     * @param i - chip index
+     * @param task - its task
+     */
+    void attach(uint8_t i, TaskHandle_t task) {
+        if (i < _count) _voices[i].task = task;
+    }
+
+    /**
+     * @brief execute the posted command, called by the synthesizer task of the chip
+     * whenever it waits (idle, broadcast barrier, end of the utterance)
+     *
+     * @param v - chip of the calling task
+     */
+    static void serve(Voice& v) {
+        auto req = v.request.load();
+        if ((req >> 8) == (v.reply.load() >> 8)) return;
+
+        bool ok = false;
+        switch (static_cast<Voice::Command>(req & 0xFF)) {
+            case Voice::Command::stop:   ok = v.chip->stop(); break;
+            case Voice::Command::volume: ok = v.chip->setVolume(v.volume.load()); break;
+            default: break;
+        }
+        v.reply.store((req & ~0xFFu) | (ok ? 1 : 0));
+    }
+
+    uint8_t size() const {
+        return _count;
+    }
+
+    Voice& voice(uint8_t i) {
+        return _voices[i];
+    }
+
+    /// @brief first chip, the default one
+    S1V30120* primary() {
+        return _count > 0 ? _voices[0].chip : nullptr;
+    }
+
+    /// @brief utterance started on a chip
+    /// @return true - the first speaking chip
+    bool startSpeaking() {
+        return _speaking.fetch_add(1) == 0;
+    }
+
+    /// @brief utterance on a chip ended
+    /// @return true - no chip speaks now
+    bool stopSpeaking() {
+        return _speaking.fetch_sub(1) == 1;
+    }
+
+    /**
+     * @brief start barrier of a broadcast, the chip waits until all copies are taken
+     * or withdrawn (a chip out of service), the timeout expires the missing copies
+     *
+     * @param v - chip with the copy taken
+     * @param timeout - longest wait for the other chips [ms]
+     * @return true - the first chip through the barrier, it reports the start
+     */
+    bool arrive(Voice& v, uint32_t timeout) {
+        const auto& u = v.utterance;
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            track(u.id);
+            _arrived++;
+        }
+        auto start = millis();
+        while (millis() - start < timeout) {
+            {
+                std::lock_guard<std::mutex> lck(_mtx);
+                if (_arrivedId != u.id || _arrived + _missing >= u.copies) break;
+            }
+            serve(v);
+            vTaskDelay(1);
+        }
+        std::lock_guard<std::mutex> lck(_mtx);
+        auto first = _arrivedId == u.id && _open;
+        if (first) _open = false;
+        return first;
+    }
+
+    /**
+     * @brief a copy of the broadcast will never arrive, its chip went out of service
+     * after the other copies were taken (TalkQueue::setReady())
+     *
+     * @param id - broadcast
+     */
+    void withdraw(uint32_t id) {
+        std::lock_guard<std::mutex> lck(_mtx);
+        track(id);
+        _missing++;
+    }
+
+    /**
+     * @brief end of a broadcast copy
+     *
+     * @param u - copy spoken by the chip
+     * @return true - the last chip, it reports the end
+     */
+    bool finish(const Utterance& u) {
+        std::lock_guard<std::mutex> lck(_mtx);
+        if (_finishedId != u.id) {
+            _finishedId = u.id;
+            _finished = 0;
+        }
+        uint8_t missing = _arrivedId == u.id ? _missing : 0;
+        return ++_finished + missing == u.copies;
+    }
+
+    /// @brief at least one chip initialized
+    bool isReady() const {
+        for (uint8_t i = 0; i < _count; i++) {
+            if (_voices[i].chip->isReady()) return true;
+        }
+        return false;
+    }
+
+    /// @brief at least one chip speaks
+    bool isRunning() {
+        for (uint8_t i = 0; i < _count; i++) {
+            if (_voices[i].chip->isReady() && _voices[i].chip->isRunning()) return true;
+        }
+        return false;
+    }
+
+    /// @brief some chip failed repeatedly and is not recovered yet
+    bool isFailed() const {
+        for (uint8_t i = 0; i < _count; i++) {
+            if (_voices[i].failed) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief stop the current utterances
+     *
+     * @return true - all ready chips stopped
+     * @return false - no chip ready or some of them failed
+     */
+    bool stop() {
+        return command(Voice::Command::stop, 0);
+    }
+
+    /**
+     * @brief audio volume of all chips
+     *
+     * @param db - volume [dB], 0 - maximum
+     * @return true - set on all ready chips
+     * @return false - no chip ready or some of them failed
+     */
+    bool setVolume(int16_t db) {
+        return command(Voice::Command::volume, db);
+    }
+
+private:
+
+    /// @brief barrier of the broadcast, a new one resets it, locked
+    void track(uint32_t id) {
+        if (_arrivedId == id) return;
+        _arrivedId = id;
+        _arrived = 0;
+        _missing = 0;
+        _open = true;
+    }
+
+    /// @brief post the command to the tasks of the ready chips and wait until they execute it
+    bool command(Voice::Command cmd, int16_t volume) {
+        std::lock_guard<std::mutex> lck(_cmdMtx);
+        bool rc = isReady();
+        uint32_t req = (++_sequence << 8) | static_cast<uint8_t>(cmd);
+        uint8_t posted = 0;
+        for (uint8_t i = 0; i < _count; i++) {
+            auto& v = _voices[i];
+            if (!v.chip->isReady() || !v.task) continue;
+            v.volume.store(volume);
+            v.request.store(req);
+            xTaskNotifyGive(v.task);
+            posted |= 1 << i;
+        }
+
+        auto start = millis();
+        while (posted) {
+            for (uint8_t i = 0; i < _count; i++) {
+                if (!(posted & (1 << i))) continue;
+                auto reply = _voices[i].reply.load();
+                if ((reply >> 8) != (req >> 8)) continue;
+                if (!(reply & 1)) rc = false;
+                posted &= ~(1 << i);
+            }
+            if (!posted) break;
+            if (millis() - start > commandTimeout) {
+                rc = false;
+                break;
+            }
+            vTaskDelay(1);
+        }
+        return rc;
+    }
+};
@@ -0,0 +1,433 @@
+/**
+ * @file talk_queue.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Queue of utterances waiting for the synthesizer
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <mutex>
+#include <functional>
+#include <string_view>
+#include "S1V30120.h"
+#include "metrics.h"
+#include "zones.h"
+
+/**
+ * @brief life cycle of the utterance
+ *
+ */
+enum class TalkEvent : uint8_t { queued, started, finished, dropped };
+
+/**
+ * @brief observer of the utterance life cycle, called from the task that caused the event
+ *
+ */
+using TalkListener = std::function<void(TalkEvent ev, uint32_t id)>;
+
+/**
+ * @brief one message prepared for the synthesizer
+ *
+ */
+struct Utterance {
+    uint32_t    id  {0};                              ///> unique message id, never 0
+    uint32_t    group {0};                            ///> id of the first part of a split text
+    uint16_t    len {0};                              ///> text length
+    uint8_t     chip {ZoneTable::anyChip};            ///> target chip
+    uint8_t     zones {0};                            ///> relays of the chip, 0 - all
+    uint8_t     copies {1};                           ///> > 1 - broadcast, one copy per chip
+    bool        urgent {false};                       ///> queued before the normal ones
+    char        text[S1V30120::maximumMsgSize + 1];   ///> zero terminated text
+};
+
+/**
+ * @brief Fixed size FIFO of utterances. Producers (HTTP, serial ...) push,
+ * the synthesizer tasks (one per chip) pop and speak. Every chip takes the oldest
+ * utterance routed to it, so a busy zone never delays an idle one. Untargeted
+ * utterances go to the first idle chip, the parts of one text stay on one chip.
+ * A broadcast is stored as one copy per chip in service. No heap is used, the slots are preallocated.
+ *
+ */
+class TalkQueue {
+public:
+    static const uint8_t capacity = 16;
+    static const uint8_t maxListeners = 4;
+    static const uint8_t maxConsumers = 4;
+
+private:
+    std::mutex  _mtx;                 // exclusive access
+    Utterance   _slots[capacity];     // ring of slots
+    uint8_t     _head  {0};           // oldest slot
+    uint8_t     _count {0};           // number of used slots
+    uint32_t    _lastId {0};          // last assigned id
+    TalkListener _listeners[maxListeners];
+    unsigned long _started  {0};      // start of the last started utterance
+    uint32_t    _startedId {0};       // id of the last started utterance
+    uint32_t    _average {2000};      // average duration of the utterance [ms]
+    TaskHandle_t _consumers[maxConsumers] {};   // woken up by push
+    uint8_t     _consumerCount {0};
+    uint32_t    _active[maxConsumers] {};       // group last taken by the chip
+    uint8_t     _ready {0xFF};        // mask of the chips in service, a broadcast goes to them only
+    const ZoneTable* _zones {nullptr};
+
+public:
+
+    /**
+     * @brief register observer of the utterance life cycle, call before the producers start
+     *
+     * @param listener
+     * @return true - success
+     * @return false - no free listener slot
+     */
+    bool addListener(TalkListener listener) {
+        for (auto& l : _listeners) {
+            if (!l) {
+                l = listener;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief task notified (xTaskNotifyGive) by every successful push, call before the producers start
+     *
+     * @param task - consumer waiting in ulTaskNotifyTake()
+     * @return true - success
+     * @return false - no free consumer slot
+     */
+    bool addConsumer(TaskHandle_t task) {
+        if (!task || _consumerCount >= maxConsumers) return false;
+        _consumers[_consumerCount++] = task;
+        return true;
+    }
+
+    /**
+     * @brief routing table of the zones, call before the producers start
+     *
+     * @param zones - table
+     */
+    void setZones(const ZoneTable* zones) {
+        _zones = zones;
+    }
+
+    /**
+     * @brief zone tag "@name " at the beginning of the text, only a configured zone or "all"
+     * is a tag, other texts starting with '@' are spoken as they are
+     *
+     * @param text - text
+     * @param len - text length
+     * @param nameLen - out, length of the name following '@'
+     * @return size_t - length of the tag including the space, 0 - no tag
+     */
+    size_t tag(const char* text, size_t len, size_t& nameLen) const {
+        uint8_t chips = 0;
+        uint8_t zones = 0;
+        size_t skip = ZoneTable::tag(text, len, nameLen);
+        return skip && _zones && _zones->resolve(text + 1, nameLen, chips, zones) ? skip : 0;
+    }
+
+    /**
+     * @brief chip taken in or out of service, called by its synthesizer task. The chips
+     * start in service, a failed one gets no broadcast until it recovers and its waiting
+     * copies are removed, the other copies of the broadcast do not wait for it.
+     *
+     * A failed chip also releases the text it was speaking, the remaining parts go to
+     * the other chips.
+     *
+     * @param chip - chip index
+     * @param ready - true - initialized
+     * @return uint32_t - the oldest broadcast whose copy was removed while the other chips
+     *                    had taken theirs already (SynthPool::withdraw()), 0 - none
+     */
+    uint32_t setReady(uint8_t chip, bool ready) {
+        uint32_t rc = 0;
+        if (chip >= 8) return rc;
+        std::lock_guard<std::mutex> lck(_mtx);
+        if (ready) {
+            _ready |= 1 << chip;
+            return rc;
+        }
+        _ready &= ~(1 << chip);
+        // the rest of its text goes to the other chips
+        if (chip < maxConsumers) _active[chip] = 0;
+        for (uint8_t n = 0; n < _count; ) {
+            auto& slot = _slots[(_head + n) % capacity];
+            if (slot.chip != chip || slot.copies < 2) {
+                n++;
+                continue;
+            }
+            uint8_t waiting = 0;
+            for (uint8_t i = 0; i < _count; i++) {
+                auto& other = _slots[(_head + i) % capacity];
+                if (other.id != slot.id) continue;
+                waiting++;
+                if (other.chip != chip) other.copies--;
+            }
+            if (!rc && waiting < slot.copies) rc = slot.id;
+            remove(n);
+        }
+        return rc;
+    }
+
+    /**
+     * @brief inform the observers, never called with the lock held
+     *
+     * @param ev - event
+     * @param id - utterance id
+     */
+    void notify(TalkEvent ev, uint32_t id) {
+        switch (ev) {
+            case TalkEvent::queued:   metrics().accepted.inc(); break;
+            case TalkEvent::finished: metrics().spoken.inc(); break;
+            case TalkEvent::dropped:  metrics().dropped.inc(); break;
+            default: break;
+        }
+
+        if (ev == TalkEvent::started || ev == TalkEvent::finished) {
+            // several synthesizer tasks report, eta() reads it from the producers
+            std::lock_guard<std::mutex> lck(_mtx);
+            if (ev == TalkEvent::started) {
+                _started = millis();
+                _startedId = id;
+            } else if (_started && id == _startedId) {
+                // exponential average, 1/8 weight of the new sample
+                uint32_t duration = millis() - _started;
+                _average = (_average * 7 + duration) / 8;
+                _started = 0;
+            }
+        }
+
+        // outside the lock, the listeners may call back into the queue
+        for (auto& l : _listeners) {
+            if (l) l(ev, id);
+        }
+    }
+
+    /**
+     * @brief append text as a new utterance
+     *
+     * @param text - text, need not be zero terminated
+     * @param len - text length, longer text is cut to maximumMsgSize
+     * @param id - optional, id assigned to the utterance even if it was dropped
+     * @param urgent - true - goes before all waiting utterances except the earlier urgent ones
+     * @param zone - target zone, nullptr or empty - "@zone " at the beginning of the text or any chip
+     * @param group - id of the first part of the same text, 0 - none
+     * @return true - queued
+     * @return false - the queue is full, unknown zone, broadcast with no chip in service or text is empty
+     */
+    bool push(const char* text, size_t len, uint32_t* id = nullptr, bool urgent = false,
+              const char* zone = nullptr, uint32_t group = 0) {
+        uint32_t newId = 0;
+        bool rc = false;
+        do {
+            if (!text || len == 0) break;
+            if (zone && !*zone) zone = nullptr;
+            size_t nameLen = zone ? strlen(zone) : 0;
+            size_t skip = zone ? 0 : tag(text, len, nameLen);
+            const char* name = zone ? zone : text + 1;
+            text += skip;
+            len -= skip;
+            if (len > S1V30120::maximumMsgSize) len = S1V30120::maximumMsgSize;
+
+            std::lock_guard<std::mutex> lck(_mtx);
+            if (++_lastId == 0) _lastId = 1;
+            newId = _lastId;
+            if (len == 0) break;
+
+            uint8_t chips = 0;
+            uint8_t zones = 0;
+            if ((zone || skip) && (!_zones || !_zones->resolve(name, nameLen, chips, zones))) break;
+            if (zones == 0 && chips) {
+                // broadcast, the chips out of service are skipped
+                chips &= _ready;
+                if (!chips) break;
+            }
+            uint8_t copies = 0;
+            for (uint8_t c = chips; c; c >>= 1) copies += c & 1;
+            if (_count + (copies ? copies : 1) > capacity) break;
+
+            if (!chips) {
+                store(text, len, newId, group, urgent, ZoneTable::anyChip, 0, 1);
+            }
+            for (uint8_t chip = 0; chips >> chip; chip++) {
+                if (chips & (1 << chip)) store(text, len, newId, group, urgent, chip, zones, copies);
+            }
+            rc = true;
+        } while (false);
+
+        if (id) *id = newId;
+        if (newId) notify(rc ? TalkEvent::queued : TalkEvent::dropped, newId);
+        // all of them, the idle ones race for the utterance, the busy ones look again when done
+        if (rc) {
+            for (uint8_t i = 0; i < _consumerCount; i++) xTaskNotifyGive(_consumers[i]);
+        }
+        return rc;
+    }
+
+    /**
+     * @brief append text as a new utterance, see above
+     *
+     */
+    bool push(std::string_view text, uint32_t* id = nullptr, bool urgent = false,
+              const char* zone = nullptr, uint32_t group = 0) {
+        return push(text.data(), text.size(), id, urgent, zone, group);
+    }
+
+    /**
+     * @brief take the oldest utterance for the chip
+     *
+     * @param out - copy of the utterance
+     * @param chip - chip index
+     * @return true - utterance available
+     * @return false - nothing for the chip
+     */
+    bool pop(Utterance& out, uint8_t chip = 0) {
+        std::lock_guard<std::mutex> lck(_mtx);
+        for (uint8_t n = 0; n < _count; n++) {
+            auto& slot = _slots[(_head + n) % capacity];
+            if (slot.chip != ZoneTable::anyChip && slot.chip != chip) continue;
+            if (slot.chip == ZoneTable::anyChip && isTaken(slot.group, chip)) continue;
+
+            out = slot;
+            remove(n);
+            if (chip < maxConsumers) _active[chip] = out.group;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief the chip finished its utterance, called by its synthesizer task. The chip
+     * keeps the text while more of its parts wait, after the last one the text is released.
+     *
+     * @param chip - chip index
+     */
+    void done(uint8_t chip) {
+        if (chip >= maxConsumers) return;
+        std::lock_guard<std::mutex> lck(_mtx);
+        if (!isWaiting(_active[chip])) _active[chip] = 0;
+    }
+
+    /**
+     * @brief drop all waiting utterances
+     *
+     * @return size_t - number of dropped utterances
+     */
+    size_t clear() {
+        uint32_t ids[capacity];
+        size_t n = 0;
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            while (_count > 0) {
+                ids[n++] = _slots[_head].id;
+                _head = (_head + 1) % capacity;
+                _count--;
+            }
+            // no part is left for any text
+            for (auto& a : _active) a = 0;
+        }
+        // the copies of a broadcast are reported once
+        for (size_t i = 0; i < n; i++) {
+            if (i == 0 || ids[i] != ids[i - 1]) notify(TalkEvent::dropped, ids[i]);
+        }
+        return n;
+    }
+
+    /**
+     * @brief number of waiting utterances
+     *
+     * @return size_t
+     */
+    size_t size() {
+        std::lock_guard<std::mutex> lck(_mtx);
+        return _count;
+    }
+
+    /**
+     * @brief estimated time until the last queued utterance starts to play
+     *
+     * @return uint32_t - time [ms]
+     */
+    uint32_t eta() {
+        std::lock_guard<std::mutex> lck(_mtx);
+        uint32_t voices = _consumerCount > 0 ? _consumerCount : 1;
+        uint32_t rc = _count > 0 ? (_count - 1) / voices * _average : 0;
+        if (_started) {
+            uint32_t elapsed = millis() - _started;
+            if (elapsed < _average) rc += _average - elapsed;
+        }
+        return rc;
+    }
+
+    /**
+     * @brief number of free slots
+     *
+     * @return size_t
+     */
+    size_t available() {
+        std::lock_guard<std::mutex> lck(_mtx);
+        return capacity - _count;
+    }
+
+private:
+
+    /// @brief new slot, locked. The urgent slots are at the head in their arrival order,
+    /// a new urgent one goes after them, a normal one at the tail.
+    void store(const char* text, size_t len, uint32_t id, uint32_t group, bool urgent,
+               uint8_t chip, uint8_t zones, uint8_t copies) {
+        uint8_t n = _count;
+        if (urgent) {
+            n = 0;
+            while (n < _count && _slots[(_head + n) % capacity].urgent) n++;
+            for (uint8_t i = _count; i > n; i--) {
+                _slots[(_head + i) % capacity] = _slots[(_head + i - 1) % capacity];
+            }
+        }
+        auto& slot = _slots[(_head + n) % capacity];
+        slot.id = id;
+        slot.group = group ? group : id;
+        slot.len = len;
+        slot.chip = chip;
+        slot.zones = zones;
+        slot.copies = copies;
+        slot.urgent = urgent;
+        memcpy(slot.text, text, len);
+        slot.text[len] = 0;
+        _count++;
+    }
+
+    /// @brief n-th waiting slot out of the ring, locked
+    void remove(uint8_t n) {
+        if (n == 0) {
+            _head = (_head + 1) % capacity;
+        } else {
+            for (uint8_t i = n; i + 1 < _count; i++) {
+                _slots[(_head + i) % capacity] = _slots[(_head + i + 1) % capacity];
+            }
+        }
+        _count--;
+    }
+
+    /// @brief a part of the text waits, locked
+    bool isWaiting(uint32_t group) const {
+        for (uint8_t i = 0; group && i < _count; i++) {
+            if (_slots[(_head + i) % capacity].group == group) return true;
+        }
+        return false;
+    }
+
+    /// @brief other chip speaks the previous part of the same text, locked
+    bool isTaken(uint32_t group, uint8_t chip) const {
+        for (uint8_t i = 0; i < _consumerCount; i++) {
+            if (i != chip && _active[i] == group) return true;
+        }
+        return false;
+    }
+};
@@ -11,11 +11,20 @@
 
 #pragma once
 
+#include <new>
 #include <WiFi.h>
 #include <AsyncTCP.h>
 #include <ESPAsyncWebServer.h>
 #include "file_sys.h"
 #include "build_in_led.h"
+#include "talk_queue.h"
+#include "talk_stream.h"
+#include "udp_server.h"
+#include "web_assets.h"
+#include "metrics.h"
+#include "boot_profile.h"
+#include "tasks.h"
+#include "slab_pool.h"
 
 /**
  * @brief Talk WWW severver
@@ -26,14 +35,61 @@ class TalkServer {
 private:
 
     AsyncWebServer*     _as    {nullptr};
+    AsyncWebSocket*     _ws    {nullptr};     // owned by _as
     ItemFS*             _fs    {nullptr};
     S1V30120*           _talker{nullptr};
     BuildInLed*         _binled{nullptr};  
+    TalkQueue*          _queue {nullptr};
+    UdpServer*          _udp   {nullptr};
+    TalkStreamSet<4>    _wsStreams;                 // fragmented WS messages in progress, by client
 
     const char*         _talkstr = "talk";   
+    const char*         _zonestr = "zone";
     const char*         _txtstr  = "text/html";
     const char*         _txtplainstr  = "text/plain";
     const char*         _talkhtmstr  = "/talk.html";
+    const char*         _stylestr  = "/style.css";
+    const char*         _cssstr  = "text/css";
+    const char*         _jsonstr  = "application/json";
+    const char*         _cachestr  = "public, max-age=86400";
+    const char*         _promstr  = "text/plain; version=0.0.4";
+
+    static constexpr uint8_t slabClasses = 2;
+    static constexpr uint8_t maxStreams = 6;    // streamed /talk bodies at once
+    static constexpr uint8_t maxScrapes = 2;    // /metrics scrapes at once
+
+    /**
+     * @brief values of one /metrics scrape, lives in the request's _tempObject
+     *
+     */
+    struct Scrape {
+        Metrics::Snapshot   core;
+        BootProfile::Snapshot boot;
+        uint32_t            queue;
+        bool                hasUdp;
+        UdpServer::Stats    udp;
+        Tasks::Snapshot     tasks;
+        SlabSnapshot<slabClasses> pool;
+    };
+
+    /**
+     * @brief slab classes of the per-request state, one per kind of object, sized by its sizeof
+     *
+     */
+    struct Slabs {
+        static constexpr uint8_t classes = slabClasses;
+        static constexpr uint16_t sizes[classes] = { slabSize(sizeof(TalkStream)), slabSize(sizeof(Scrape)) };
+        static constexpr uint8_t counts[classes] = { maxStreams, maxScrapes };
+    };
+    static_assert(sizeof(TalkStream) <= Slabs::sizes[0] && sizeof(Scrape) <= Slabs::sizes[1], "request state larger than its slab");
+    static_assert(alignof(TalkStream) <= 8 && alignof(Scrape) <= 8, "slabs are 8 byte aligned");
+
+    /// @brief the pool of the per-request state, shared by all servers
+    static SlabPool<Slabs>& slabs() {
+        static SlabPool<Slabs> p;
+        return p;
+    }
+    const char*         _wsstr  = "/ws";
 
  public: 
 
@@ -41,11 +97,15 @@ private:
      * @brief Construct a new Talk server object
      * 
      * @param fs 
+     * @param talker - synthesizer
+     * @param binled - status LED
+     * @param queue - queue of utterances
      */
-    explicit TalkServer(ItemFS* fs, S1V30120 *talker, BuildInLed*  binled) : 
+    explicit TalkServer(ItemFS* fs, S1V30120 *talker, BuildInLed*  binled, TalkQueue* queue) : 
         _fs(fs), 
         _talker(talker), 
-        _binled(binled) {
+        _binled(binled),
+        _queue(queue) {
     } 
 
     /**
@@ -80,24 +140,224 @@ private:
     void done() {
         if (_as) delete(_as);
         _as = nullptr; 
+        _ws = nullptr;
     }
 
-    /// @brief non blocking speach
-    /// @param txt test to speach
-    /// @return 
-    bool nonBlockingTalk(const String& txt) {
-        bool rc = false;
-        if (_talker && _binled && !txt.isEmpty() && txt.length() <= _talker->maximumMsgSize) {
-            if (!_talker->isRunning()) {
-                _talker->speak(txt, false, true);
-                _binled->setState(BuildInLed::State::on);
-                rc = true;
-            }
-            _binled->update();
+    /// @brief UDP server reported by /diag
+    /// @param udp
+    void attach(UdpServer* udp) {
+        _udp = udp;
+    }
+
+    /// @brief Prometheus text of the scrape
+    static void renderMetrics(const Scrape& sc, MetricsWriter& w) {
+        Metrics::render(sc.core, w);
+        BootProfile::render(sc.boot, w);
+        Tasks::render(sc.tasks, w);
+        SlabPool<Slabs>::render(sc.pool, w);
+        w.metric("dectalk_queue_depth", "gauge", sc.queue);
+        if (sc.hasUdp) {
+            w.type("dectalk_udp_datagrams_total", "counter");
+            w.sample("dectalk_udp_datagrams_total", "result=\"queued\"", sc.udp.queued);
+            w.sample("dectalk_udp_datagrams_total", "result=\"dropped\"", sc.udp.dropped);
+            w.sample("dectalk_udp_datagrams_total", "result=\"duplicated\"", sc.udp.duplicated);
+            w.sample("dectalk_udp_datagrams_total", "result=\"invalid\"", sc.udp.invalid);
+        }
+    }
+
+    /// @brief /metrics, values are copied once and the text is rendered
+    /// directly into the TCP buffers chunk by chunk. Never touches the synthesizer.
+    void sendMetrics(AsyncWebServerRequest *request) {
+        auto sc = static_cast<Scrape*>(requestState(request, sizeof(Scrape)));
+        if (!sc) {
+            request->send(503);
+            return;
         }
+        metrics().snapshot(sc->core);
+        bootProfile().snapshot(sc->boot);
+        sc->queue = _queue->size();
+        sc->hasUdp = _udp != nullptr;
+        if (_udp) sc->udp = _udp->stats();
+        tasks().snapshot(sc->tasks);
+        slabs().snapshot(sc->pool);
+
+        MetricsWriter counter(nullptr, 0, 0);
+        renderMetrics(*sc, counter);
+        request->send(request->beginResponse(_promstr, counter.length(), [sc] (uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            MetricsWriter w(reinterpret_cast<char*>(buffer), index, maxLen);
+            renderMetrics(*sc, w);
+            return w.stored();
+        }));
+    }
+
+    /// @brief per-request state from the slab pool, kept in _tempObject.
+    /// The request frees _tempObject with free() when it is deleted, the slot
+    /// is returned in the disconnect callback that runs just before.
+    /// @return state, nullptr - pool exhausted
+    void* requestState(AsyncWebServerRequest *request, size_t size) {
+        auto mem = slabs().alloc(size);
+        if (!mem) return nullptr;
+        request->_tempObject = mem;
+        request->onDisconnect([request] () {
+            slabs().release(request->_tempObject);
+            request->_tempObject = nullptr;
+        });
+        return mem;
+    }
+
+    /// @brief periodic housekeeping, call from the housekeeping task
+    void update() {
+        if (_ws) _ws->cleanupClients();
+    }
+
+    /// @brief non blocking speach, the text is queued and spoken by the synthesizer task
+    /// @param txt test to speach, a long text is split into several utterances
+    /// @param id optional, id of the last queued utterance
+    /// @param zone optional, target zone
+    /// @return true - whole text queued
+    bool nonBlockingTalk(std::string_view txt, uint32_t* id = nullptr, const char* zone = nullptr) {
+        // one utterance with the whitespace as TalkStream leaves it goes straight into the queue slot
+        if (txt.size() <= S1V30120::maximumMsgSize && TalkStream::isCollapsed(txt)) {
+            uint32_t last = 0;
+            auto rc = _queue->push(txt, &last, false, zone);
+            if (id) *id = last;
+            return rc;
+        }
+
+        TalkStream stream(_queue, zone);
+        stream.feed(reinterpret_cast<const uint8_t*>(txt.data()), txt.size());
+        auto rc = stream.finish();
+        if (id) *id = stream.lastId();
         return rc;
     }
 
+    /// @brief parameter value without a copy
+    static std::string_view view(const String& s) {
+        return std::string_view(s.c_str(), s.length());
+    }
+
+    /// @brief target zone of /talk, query or form parameter "zone"
+    /// @return zone name valid during the request, nullptr - none
+    const char* zoneParam(AsyncWebServerRequest *request) {
+        auto p = request->getParam(_zonestr);
+        if (!p) p = request->getParam(_zonestr, true);
+        return p ? p->value().c_str() : nullptr;
+    }
+
+    /// @brief gzipped asset from flash, 304 if the client has the same version
+    void sendAsset(AsyncWebServerRequest *request, const uint8_t* gz, size_t len, const char* etag, const char* type) {
+        auto match = request->getHeader("If-None-Match");
+        if (match && match->value() == etag) {
+            request->send(304);
+            return;
+        }
+
+        auto response = request->beginResponse_P(200, type, gz, len);
+        response->addHeader("Content-Encoding", "gzip");
+        response->addHeader("ETag", etag);
+        response->addHeader("Cache-Control", _cachestr);
+        request->send(response);
+    }
+
+    /// @brief status codes of a refused body, their addresses mark the request in _tempObject
+    static constexpr int busyCode = 503;
+    static constexpr int tooLargeCode = 413;
+
+    /// @brief refuse the body of the request, the /talk handler answers with the code
+    void reject(AsyncWebServerRequest *request, const int* code) {
+        request->_tempObject = const_cast<int*>(code);
+        // never freed, the marker is removed before the request is deleted
+        request->onDisconnect([request] () {
+            request->_tempObject = nullptr;
+        });
+    }
+
+    /// @brief status code of the refused body
+    /// @return 0 - not refused
+    static int rejected(AsyncWebServerRequest *request) {
+        auto p = request->_tempObject;
+        if (p == &busyCode || p == &tooLargeCode) return *static_cast<const int*>(p);
+        return 0;
+    }
+
+    /// @brief raw body of POST /talk, consumed chunk by chunk as it arrives.
+    /// Form encoded bodies are parsed by the server itself and never come here.
+    /// A body that needs more utterances than the queue has free slots is refused
+    /// before anything is queued: 413 - never fits, 503 - try again later.
+    void talkBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+        if (index == 0 && !request->_tempObject) {
+            size_t parts = total / S1V30120::maximumMsgSize + 1;
+            if (parts > TalkQueue::capacity) {
+                reject(request, &tooLargeCode);
+                return;
+            }
+            if (parts > _queue->available()) {
+                reject(request, &busyCode);
+                return;
+            }
+            auto mem = requestState(request, sizeof(TalkStream));
+            if (!mem) {
+                // pool exhausted, the /talk handler answers 503
+                reject(request, &busyCode);
+                return;
+            }
+            auto zone = request->getParam(_zonestr);
+            new (mem) TalkStream(_queue, zone ? zone->value().c_str() : nullptr);
+        }
+        if (rejected(request)) return;
+
+        auto stream = static_cast<TalkStream*>(request->_tempObject);
+        if (stream) stream->feed(data, len);
+    }
+
+    /// @brief utterance life cycle pushed to all WebSocket clients as "<event> <id>"
+    /// Q - queued, S - started, F - finished, D - dropped
+    void wsEvent(TalkEvent ev, uint32_t id) {
+        if (!_ws || _ws->count() == 0) return;
+        static const char evchr[] = { 'Q', 'S', 'F', 'D' };
+        char buff[16];
+        auto len = snprintf(buff, sizeof(buff), "%c %u", evchr[static_cast<uint8_t>(ev)], (unsigned) id);
+        _ws->textAll(buff, len);
+    }
+
+    /// @brief result of a message sent to the originating client only, "A <id>" - queued,
+    /// "E <id>" - dropped or rejected, id of the last utterance of the message
+    void wsAck(AsyncWebSocketClient *client, bool ok, uint32_t id) {
+        char buff[16];
+        auto len = snprintf(buff, sizeof(buff), "%c %u", ok ? 'A' : 'E', (unsigned) id);
+        client->text(buff, len);
+    }
+
+    /// @brief WebSocket text frames are utterances, long messages are split.
+    /// Every client has its own fragmented message, a client beyond the free streams is refused.
+    void wsData(AsyncWebSocketClient *client, AwsFrameInfo *info, uint8_t *data, size_t len) {
+        if (info->message_opcode != WS_TEXT) return;
+
+        // complete message in a single frame, a short one goes straight into the queue slot
+        if (info->final && info->index == 0 && info->len == len) {
+            uint32_t id = 0;
+            auto rc = nonBlockingTalk(std::string_view(reinterpret_cast<const char*>(data), len), &id);
+            wsAck(client, rc, id);
+            return;
+        }
+
+        TalkStream* stream = nullptr;
+        if (info->num == 0 && info->index == 0) {
+            stream = _wsStreams.open(client->id(), _queue);
+            if (!stream) wsAck(client, false, 0);
+        } else {
+            stream = _wsStreams.find(client->id());
+        }
+        if (!stream) return;
+
+        stream->feed(data, len);
+        if (info->final && info->index + len == info->len) {
+            uint32_t id = 0;
+            auto rc = _wsStreams.close(client->id(), &id);
+            wsAck(client, rc, id);
+        }
+    }
+
     /// @brief main TALK & working with responses
     void serveTalkPage() {
         do {
@@ -106,39 +366,73 @@ private:
             if (!_talker) break;
             if (!_binled) break;
             if (!_fs) break;
+            if (!_queue) break;
             
-            // root same as /talk 
+            // root same as /talk, web UI is served from flash, not from SPIFFS
             _as->on("/", HTTP_GET, [this](AsyncWebServerRequest *request){
-                request->send(*_fs->getFS(), _talkhtmstr, _txtstr);
+                sendAsset(request, talk_html_gz, sizeof(talk_html_gz), talk_html_etag, _txtstr);
+            });
+
+            _as->on(_talkhtmstr, HTTP_GET, [this](AsyncWebServerRequest *request){
+                sendAsset(request, talk_html_gz, sizeof(talk_html_gz), talk_html_etag, _txtstr);
             });
 
-            // for static access
-            _as->serveStatic("/", *_fs->getFS(), "/");
+            _as->on(_stylestr, HTTP_GET, [this](AsyncWebServerRequest *request){
+                sendAsset(request, style_css_gz, sizeof(style_css_gz), style_css_etag, _cssstr);
+            });
 
             // specific talk POST page
             _as->on("/talk", HTTP_POST, [this] (AsyncWebServerRequest *request) {
+                auto code = rejected(request);
+                if (code) {
+                    request->send(code);
+                    return;
+                }
+                // raw text/plain body, already queued by talkBody()
+                auto stream = static_cast<TalkStream*>(request->_tempObject);
+                if (stream) {
+                    request->send(200, _txtplainstr, stream->finish()?"OK":"ERROR");
+                    return;
+                }
+                auto isOK = false;
+                uint32_t id = 0;
+                auto zone = zoneParam(request);
                 auto parnum = request->params();
                 for(auto i=0; i<parnum; i++) {
                     AsyncWebParameter* p = request->getParam(i);
                     if(p->isPost()){  
                         if (p->name()==_talkstr) {
-                            // ignore RC
-                            nonBlockingTalk(p->value());
+                            isOK = nonBlockingTalk(view(p->value()), &id, zone);
                             break;
                         }
                     }
                 }
-                request->send(*_fs->getFS(), _talkhtmstr, _txtstr);               
+
+                // scripts get a tiny ack, browsers go back to the (cached) form
+                auto accept = request->getHeader("Accept");
+                if (accept && accept->value().indexOf(_jsonstr) >= 0) {
+                    char buff[40];
+                    snprintf(buff, sizeof(buff), "{\"ok\":%s,\"id\":%u}", isOK?"true":"false", (unsigned) id);
+                    request->send(200, _jsonstr, buff);
+                    return;
+                }
+
+                auto response = request->beginResponse(303);
+                response->addHeader("Location", "/");
+                request->send(response);
+            }, nullptr, [this] (AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+                talkBody(request, data, len, index, total);
             });
 
             // specific talk GET page
             _as->on("/talk", HTTP_GET, [this] (AsyncWebServerRequest *request) {
                 auto isOK= false;
+                auto zone = zoneParam(request);
                 auto parnum = request->params(); 
                 for(auto i=0; i<parnum; i++) {
                     AsyncWebParameter* p = request->getParam(i); 
                     if (p->name()==_talkstr) {
-                        isOK = nonBlockingTalk(p->value());
+                        isOK = nonBlockingTalk(view(p->value()), nullptr, zone);
                         break;
                     }  
                 }
@@ -147,6 +441,56 @@ private:
                 
             });
 
+            // diagnostics, counters as "name value" lines
+            _as->on("/diag", HTTP_GET, [this] (AsyncWebServerRequest *request) {
+                char buff[256];
+                auto len = snprintf(buff, sizeof(buff), "queue %u\n", (unsigned) _queue->size());
+                if (_udp) {
+                    auto& st = _udp->stats();
+                    len += snprintf(buff + len, sizeof(buff) - len,
+                                    "udp.received %u\nudp.queued %u\nudp.dropped %u\nudp.duplicated %u\nudp.invalid %u\n",
+                                    (unsigned) st.received, (unsigned) st.queued, (unsigned) st.dropped,
+                                    (unsigned) st.duplicated, (unsigned) st.invalid);
+                }
+                request->send(200, _txtplainstr, buff);
+            });
+
+            // Prometheus scrape
+            _as->on("/metrics", HTTP_GET, [this] (AsyncWebServerRequest *request) {
+                sendMetrics(request);
+            });
+
+            // binary protocol trace, only in the -D S1V30120_TRACE build
+            if (S1V30120::TracePolicy::enabled) {
+                _as->on("/trace", HTTP_GET, [] (AsyncWebServerRequest *request) {
+                    // consistent copy, released by AsyncWebServerRequest with free()
+                    auto len = S1V30120::TracePolicy::size();
+                    auto copy = static_cast<uint8_t*>(malloc(len));
+                    if (!copy) {
+                        request->send(503);
+                        return;
+                    }
+                    request->_tempObject = copy;
+                    len = S1V30120::TracePolicy::dump(copy, 0, len);
+                    request->send(request->beginResponse_P(200, "application/octet-stream", copy, len));
+                });
+            }
+
+            // persistent connection, utterances in, life cycle events out
+            _ws = new AsyncWebSocket(_wsstr);
+            if (!_ws) break;
+            _ws->onEvent([this] (AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len) {
+                if (type == WS_EVT_DATA) {
+                    wsData(client, static_cast<AwsFrameInfo*>(arg), data, len);
+                } else if (type == WS_EVT_DISCONNECT) {
+                    _wsStreams.close(client->id());
+                }
+            });
+            _as->addHandler(_ws);
+            _queue->addListener([this] (TalkEvent ev, uint32_t id) {
+                wsEvent(ev, id);
+            });
+
             _as->begin();
         } while(false);
     }   
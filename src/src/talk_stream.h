@@ -0,0 +1,197 @@
+/**
+ * @file talk_stream.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Incremental text ingestion, splits a long text into utterances
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "talk_queue.h"
+
+/**
+ * @brief Consumes text in arbitrary chunks (HTTP body, WebSocket fragments, TCP lines ...)
+ * and cuts it at word boundaries into utterances
+ * of at most maximumMsgSize characters. Complete utterances are pushed to the
+ * queue immediately, so speech can start before the whole text arrives.
+ * Memory is bounded by one utterance regardless of the text size.
+ * All parts go to one zone, given by the owner or by "@zone " at the beginning of the text
+ * (a configured zone or "all", otherwise the tag is a part of the text).
+ *
+ * Producers push a text the stream would pass unchanged and that fits one utterance
+ * straight into the queue (isCollapsed()), only the rewritten or split text is buffered here.
+ *
+ * The object is trivially destructible, it can live in memory released by free().
+ *
+ */
+class TalkStream {
+private:
+    TalkQueue*  _queue  {nullptr};
+    bool        _urgent {false};      // all parts go before the normal utterances
+    bool        _failed {false};      // some part of the text was dropped
+    uint16_t    _len    {0};          // characters in _buf
+    uint16_t    _cut    {0};          // preferred split position, 0 - none
+    uint32_t    _lastId {0};          // id of the last pushed utterance
+    uint32_t    _group  {0};          // id of the first pushed utterance
+    char        _zone[ZoneTable::maxName + 2] {};   // target zone, longer names never match
+    char        _buf[S1V30120::maximumMsgSize];
+
+public:
+
+    /**
+     * @brief Construct a new Talk Stream object
+     *
+     * @param queue - target queue
+     * @param zone - target zone, nullptr - "@zone " tag in the text or any chip
+     * @param urgent - true - the parts go before the waiting utterances, in their order
+     */
+    explicit TalkStream(TalkQueue* queue, const char* zone = nullptr, bool urgent = false) : _queue(queue), _urgent(urgent) {
+        if (zone) strncpy(_zone, zone, sizeof(_zone) - 1);
+    }
+
+    /**
+     * @brief consume next chunk of the text
+     *
+     * @param data - chunk
+     * @param len - chunk length
+     */
+    void feed(const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) append(data[i]);
+    }
+
+    /**
+     * @brief push the rest of the text
+     *
+     * @return true - whole text was queued
+     * @return false - the queue overflowed or text was empty
+     */
+    bool finish() {
+        if (_len) flush(_len);
+        return !_failed && _lastId != 0;
+    }
+
+    /**
+     * @brief the text is passed unchanged - no leading space, no line break or tab, no space run
+     *
+     * @param txt - text
+     * @return true - the stream would queue the same characters, a copy can go straight to the queue
+     * @return false - empty or the whitespace is to be collapsed
+     */
+    static bool isCollapsed(std::string_view txt) {
+        return !txt.empty() && txt.front() != ' ' && txt.find_first_of("\r\n\t") == std::string_view::npos &&
+               txt.find("  ") == std::string_view::npos;
+    }
+
+    /**
+     * @brief id of the last queued utterance
+     *
+     * @return uint32_t - id or 0
+     */
+    uint32_t lastId() const {
+        return _lastId;
+    }
+
+private:
+
+    /// @brief append character, split when the buffer is full
+    void append(char ch) {
+        if (ch == '\r' || ch == '\n' || ch == '\t') ch = ' ';
+        if (ch == ' ' && (_len == 0 || _buf[_len - 1] == ' ')) return;
+
+        if (_len == sizeof(_buf)) {
+            flush(_cut ? _cut : _len);
+        }
+
+        _buf[_len++] = ch;
+        if (ch == ' ' || ch == '.' || ch == ',' || ch == ';' || ch == '!' || ch == '?') {
+            _cut = _len;
+        }
+    }
+
+    /// @brief push the first n characters and keep the rest
+    void flush(uint16_t n) {
+        uint32_t id = 0;
+        size_t skip = 0;
+        if (!_group && !_zone[0] && _queue) {
+            // zone tag of the first part applies to the whole text, unknown names are text
+            size_t nameLen = 0;
+            skip = _queue->tag(_buf, n, nameLen);
+            if (skip) memcpy(_zone, _buf + 1, nameLen < sizeof(_zone) - 1 ? nameLen : sizeof(_zone) - 1);
+        }
+        if (!_queue || !_queue->push(_buf + skip, n - skip, &id, _urgent, _zone, _group)) _failed = true;
+        if (id) _lastId = id;
+        if (!_group) _group = id;
+
+        _len -= n;
+        memmove(_buf, _buf + n, _len);
+        _cut = 0;
+    }
+};
+
+/**
+ * @brief Streams of several owners in progress at once, e.g. fragmented
+ * WebSocket messages of different clients. Fixed slots, nothing is allocated.
+ *
+ * @tparam Size - streams in progress
+ */
+template <uint8_t Size>
+class TalkStreamSet {
+private:
+    struct Slot {
+        uint32_t    owner {0};      // 0 - free
+        TalkStream  stream {nullptr};
+    };
+    Slot    _slots[Size];
+
+public:
+
+    /**
+     * @brief new stream of the owner, the pending one of the same owner is finished first
+     *
+     * @param owner - owner id, not 0
+     * @param queue - target queue
+     * @return TalkStream* - stream, nullptr - all slots are taken
+     */
+    TalkStream* open(uint32_t owner, TalkQueue* queue) {
+        close(owner);
+        for (auto& s : _slots) {
+            if (s.owner) continue;
+            s.owner = owner;
+            s.stream = TalkStream(queue);
+            return &s.stream;
+        }
+        return nullptr;
+    }
+
+    /// @brief stream of the owner, nullptr - none
+    TalkStream* find(uint32_t owner) {
+        for (auto& s : _slots) {
+            if (owner && s.owner == owner) return &s.stream;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief push the rest of the owner's text and free the slot
+     *
+     * @param owner - owner id
+     * @param id - optional, id of the last queued utterance
+     * @return true - whole text was queued
+     * @return false - overflow, empty text or no stream of the owner
+     */
+    bool close(uint32_t owner, uint32_t* id = nullptr) {
+        for (auto& s : _slots) {
+            if (!owner || s.owner != owner) continue;
+            s.owner = 0;
+            auto rc = s.stream.finish();
+            if (id) *id = s.stream.lastId();
+            return rc;
+        }
+        return false;
+    }
+};
@@ -0,0 +1,157 @@
+/**
+ * @file tasks.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Application tasks pinned to cores, shared event bits & stack watermarks
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/event_groups.h>
+#include "metrics.h"
+
+/**
+ * @brief Registry of the application tasks. Core 0 runs networking (WiFi, AsyncTCP)
+ * and the light tasks, core 1 belongs to the synthesizer. The tasks share state
+ * through the event group, the utterances go through TalkQueue.
+ *
+ */
+class Tasks {
+public:
+    static const uint8_t maxTasks = 8;       // wifi, serial, house, led & synthesizer per chip
+
+    // event bits
+    static const EventBits_t chipReady  = 1 << 0;   ///> at least one S1V30120 initialized
+    static const EventBits_t chipFailed = 1 << 1;   ///> some S1V30120 init failed
+    static const EventBits_t wifiUp     = 1 << 2;   ///> station connected
+    static const EventBits_t speaking   = 1 << 3;   ///> utterance in progress on some chip
+
+    // cores
+    static const BaseType_t netCore   = 0;
+    static const BaseType_t synthCore = 1;
+
+    /**
+     * @brief stack high-water marks of one scrape
+     *
+     */
+    struct Snapshot {
+        uint8_t     count;
+        const char* name[maxTasks];
+        uint32_t    free[maxTasks];         // minimum ever free stack [bytes]
+    };
+
+private:
+
+    struct Entry {
+        const char*     name   {nullptr};
+        TaskHandle_t    handle {nullptr};
+    };
+
+    Entry               _tasks[maxTasks];
+    uint8_t             _count  {0};
+    EventGroupHandle_t  _events {nullptr};
+
+public:
+
+    /**
+     * @brief create the event group, call before start()
+     *
+     * @return true - success
+     * @return false
+     */
+    bool init() {
+        if (!_events) _events = xEventGroupCreate();
+        return _events != nullptr;
+    }
+
+    /**
+     * @brief create a task pinned to the core
+     *
+     * @param fn - task function, never returns
+     * @param name - task name, static string
+     * @param stack - stack size [bytes]
+     * @param prio - priority
+     * @param core - netCore or synthCore
+     * @param arg - task argument
+     * @return TaskHandle_t - nullptr if failed
+     */
+    TaskHandle_t start(TaskFunction_t fn, const char* name, uint32_t stack, UBaseType_t prio, BaseType_t core, void* arg = nullptr) {
+        TaskHandle_t handle = nullptr;
+        do {
+            if (_count >= maxTasks) break;
+            if (xTaskCreatePinnedToCore(fn, name, stack, arg, prio, &handle, core) != pdPASS) {
+                handle = nullptr;
+                break;
+            }
+            _tasks[_count].name = name;
+            _tasks[_count].handle = handle;
+            _count++;
+        } while (false);
+        return handle;
+    }
+
+    void set(EventBits_t bits) {
+        xEventGroupSetBits(_events, bits);
+    }
+
+    void clear(EventBits_t bits) {
+        xEventGroupClearBits(_events, bits);
+    }
+
+    EventBits_t bits() const {
+        return xEventGroupGetBits(_events);
+    }
+
+    /// @brief wait for any of the bits
+    /// @return bits at the time of return
+    EventBits_t wait(EventBits_t bits, TickType_t ticks = portMAX_DELAY) {
+        return xEventGroupWaitBits(_events, bits, pdFALSE, pdFALSE, ticks);
+    }
+
+    void snapshot(Snapshot& s) const {
+        s.count = _count;
+        for (uint8_t i = 0; i < _count; i++) {
+            s.name[i] = _tasks[i].name;
+            s.free[i] = uxTaskGetStackHighWaterMark(_tasks[i].handle);
+        }
+    }
+
+    static void render(const Snapshot& s, MetricsWriter& w) {
+        char labels[32];
+        w.type("dectalk_task_stack_free_bytes", "gauge");
+        for (uint8_t i = 0; i < s.count; i++) {
+            snprintf(labels, sizeof(labels), "task=\"%s\"", s.name[i]);
+            w.sample("dectalk_task_stack_free_bytes", labels, s.free[i]);
+        }
+    }
+
+    /**
+     * @brief stack high-water marks as "#TASK" line
+     *
+     * @param out - e.g. Serial
+     */
+    void report(Print& out) const {
+        out.print("#TASK");
+        for (uint8_t i = 0; i < _count; i++) {
+            out.printf(" %s=%uB", _tasks[i].name, (unsigned) uxTaskGetStackHighWaterMark(_tasks[i].handle));
+        }
+        out.println();
+    }
+};
+
+/**
+ * @brief the application tasks
+ *
+ * @return Tasks&
+ */
+inline Tasks& tasks() {
+    static Tasks t;
+    return t;
+}
@@ -0,0 +1,227 @@
+/**
+ * @file udp_server.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief UDP fire-and-forget speak port
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <AsyncUDP.h>
+#include "talk_queue.h"
+#include "talk_stream.h"
+
+/**
+ * @brief UDP listener, one utterance per datagram, no answer.
+ * The datagram is either the plain text or a header followed by the text:
+ *
+ *   | 0x01 | priority | seq LSB | seq MSB | text ... |
+ *
+ * priority > 0 puts the utterance before all waiting ones, after the earlier urgent ones.
+ * Sequence numbers are tracked per sender (IP & port) in a sliding window, repeated
+ * datagrams are discarded. The text is normalized and split like every other input (TalkStream),
+ * a datagram longer than maximumMsgSize becomes several utterances.
+ *
+ */
+class UdpServer {
+public:
+    static const uint8_t maxSenders = 8;
+    static const uint8_t header = 0x01;
+    static const uint8_t headerSize = 4;
+
+    /**
+     * @brief counters for the diagnostics
+     *
+     */
+    struct Stats {
+        uint32_t received   {0};    ///> all datagrams
+        uint32_t queued     {0};    ///> accepted utterances
+        uint32_t dropped    {0};    ///> queue was full
+        uint32_t duplicated {0};    ///> discarded by the sequence window
+        uint32_t invalid    {0};    ///> empty, white space only or malformed
+    };
+
+private:
+
+    /**
+     * @brief sliding window of the sender, bit N of mask = seq (last - N) was seen
+     *
+     */
+    struct Sender {
+        uint32_t        ip   {0};
+        uint16_t        port {0};
+        uint16_t        last {0};   // highest sequence number seen
+        uint32_t        mask {0};   // 0 - unused entry
+        unsigned long   used {0};   // for replacement of the oldest sender
+    };
+
+    AsyncUDP*   _udp   {nullptr};
+    TalkQueue*  _queue {nullptr};
+    uint16_t    _port  {0};
+    Sender      _senders[maxSenders];
+    const unsigned long _expire {60000};   // silent sender starts a new sequence [ms]
+    Stats       _stats;
+
+public:
+
+    /**
+     * @brief Construct a new Udp Server object
+     *
+     * @param queue - queue of utterances
+     */
+    explicit UdpServer(TalkQueue* queue) : _queue(queue) {
+    }
+
+    /**
+     * @brief Destroy the Udp Server object
+     *
+     */
+    ~UdpServer() {
+        done();
+    }
+
+    /**
+     * @brief start listening
+     *
+     * @param port - listen port
+     * @return true - success
+     * @return false
+     */
+    bool init(uint16_t port = 7000) {
+        bool rc = false;
+        do {
+            if (_udp) done();
+            if (!_queue) break;
+            _udp = new AsyncUDP();
+            if (_udp == nullptr) break;
+            _port = port;
+            if (!_udp->listen(port)) break;
+
+            _udp->onPacket([this] (AsyncUDPPacket& packet) {
+                receive(packet.remoteIP(), packet.remotePort(), packet.data(), packet.length());
+            });
+            rc = true;
+        } while (false);
+        return rc;
+    }
+
+    /**
+     * @brief bind the listener again, call after the station reconnected
+     *
+     * @return true - success
+     * @return false - not initialized or listen failed
+     */
+    bool restart() {
+        if (!_udp) return false;
+        _udp->close();
+        return _udp->listen(_port);
+    }
+
+    /**
+     * @brief down server
+     *
+     */
+    void done() {
+        if (_udp) delete(_udp);
+        _udp = nullptr;
+    }
+
+    /**
+     * @brief counters
+     *
+     * @return const Stats&
+     */
+    const Stats& stats() const {
+        return _stats;
+    }
+
+private:
+
+    /// @brief process one datagram
+    void receive(uint32_t ip, uint16_t port, const uint8_t* data, size_t len) {
+        _stats.received++;
+
+        bool urgent = false;
+        if (len > 0 && data[0] == header) {
+            if (len <= headerSize) {
+                _stats.invalid++;
+                return;
+            }
+            urgent = data[1] > 0;
+            uint16_t seq = data[2] | (data[3] << 8);
+            if (isDuplicate(ip, port, seq)) {
+                _stats.duplicated++;
+                return;
+            }
+            data += headerSize;
+            len -= headerSize;
+        }
+
+        // one utterance the stream would not change is copied straight into the queue slot
+        std::string_view txt(reinterpret_cast<const char*>(data), len);
+        if (len <= S1V30120::maximumMsgSize && TalkStream::isCollapsed(txt)) {
+            if (_queue->push(txt, nullptr, urgent)) _stats.queued++;
+            else _stats.dropped++;
+            return;
+        }
+
+        TalkStream stream(_queue, nullptr, urgent);
+        stream.feed(data, len);
+        auto rc = stream.finish();
+        if (stream.lastId() == 0) _stats.invalid++;       // nothing but white space
+        else if (rc) _stats.queued++;
+        else _stats.dropped++;
+    }
+
+    /// @brief sequence window check, marks the sequence number as seen
+    /// @return true - already seen or too old
+    bool isDuplicate(uint32_t ip, uint16_t port, uint16_t seq) {
+        Sender* sender = nullptr;
+        Sender* oldest = &_senders[0];
+        for (auto& s : _senders) {
+            if (s.mask && s.ip == ip && s.port == port) {
+                sender = &s;
+                break;
+            }
+            if (!s.mask || s.used < oldest->used) oldest = &s;
+        }
+
+        if (!sender) {
+            // new sender, replace unused or least recently used entry
+            sender = oldest;
+            sender->ip = ip;
+            sender->port = port;
+            sender->last = seq;
+            sender->mask = 1;
+            sender->used = millis();
+            return false;
+        }
+        if (millis() - sender->used > _expire) {
+            // sender was silent (restarted?), the window starts again
+            sender->last = seq;
+            sender->mask = 1;
+            sender->used = millis();
+            return false;
+        }
+        sender->used = millis();
+
+        int16_t diff = static_cast<int16_t>(seq - sender->last);
+        if (diff > 0) {
+            // newer, slide the window
+            sender->mask = (diff >= 32) ? 1 : (sender->mask << diff) | 1;
+            sender->last = seq;
+            return false;
+        }
+
+        auto age = static_cast<uint16_t>(-diff);
+        if (age >= 32) return true;
+        uint32_t bit = 1UL << age;
+        if (sender->mask & bit) return true;
+        sender->mask |= bit;
+        return false;
+    }
+};
@@ -0,0 +1,78 @@
+/**
+ * @file web_assets.h
+ * @brief Web UI gzipped at build time, generated by tools/embed_assets.py from data/
+ *
+ * Do not edit, the file is overwritten when the data/ sources change.
+ */
+
+#pragma once
+#include <inttypes.h>
+#include <pgmspace.h>
+
+// talk.html, 551 bytes, gzip 287 bytes
+static const uint8_t talk_html_gz[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x75, 0x52, 0xc1, 0x6e, 0xc3, 0x20,
+  0x0c, 0xbd, 0xf7, 0x2b, 0x18, 0xf7, 0x0d, 0xed, 0x4e, 0x22, 0x4d, 0x6d, 0x0f, 0xd3, 0x26, 0xb5,
+  0x52, 0x73, 0xd9, 0x91, 0x04, 0x77, 0x41, 0x25, 0x10, 0x81, 0x13, 0x2d, 0x7f, 0x3f, 0x93, 0x34,
+  0x1d, 0xeb, 0xb4, 0x13, 0xb6, 0xdf, 0x7b, 0xb6, 0x79, 0x20, 0x1f, 0x76, 0x87, 0x6d, 0xf5, 0x71,
+  0xdc, 0xb3, 0x16, 0x3b, 0x5b, 0x6e, 0xe4, 0x7a, 0x80, 0xd2, 0xe5, 0x86, 0x31, 0x89, 0x06, 0x2d,
+  0x94, 0xbb, 0xfd, 0xb6, 0x7a, 0x79, 0x7f, 0x93, 0x62, 0x49, 0x13, 0x60, 0x8d, 0xbb, 0xb0, 0x00,
+  0xb6, 0xe0, 0x11, 0x27, 0x0b, 0xb1, 0x05, 0x40, 0xce, 0x70, 0xea, 0xa1, 0xe0, 0x08, 0x5f, 0x28,
+  0x9a, 0x18, 0x39, 0x6b, 0x03, 0x9c, 0xaf, 0x8c, 0xa7, 0x54, 0xa0, 0xd6, 0x62, 0xe9, 0x2d, 0x6b,
+  0xaf, 0xa7, 0xb9, 0x93, 0x36, 0x23, 0x6b, 0xac, 0x8a, 0x91, 0x84, 0xbe, 0x77, 0x6a, 0xe4, 0xa9,
+  0x4c, 0x40, 0xfb, 0xfc, 0x33, 0x98, 0xe2, 0xc4, 0x15, 0x44, 0xbe, 0x17, 0x35, 0xde, 0x21, 0x38,
+  0x5c, 0x55, 0x39, 0xa2, 0x82, 0x7e, 0xfc, 0x0c, 0x46, 0x5f, 0xb1, 0xbf, 0xe8, 0x0d, 0x20, 0xe8,
+  0xec, 0x43, 0xc7, 0x54, 0x83, 0xc6, 0xbb, 0x82, 0x0b, 0x54, 0xf6, 0xc2, 0x59, 0x07, 0xd8, 0x7a,
+  0x5d, 0xf0, 0xe3, 0xe1, 0x54, 0x65, 0x5c, 0x62, 0xf7, 0x79, 0x96, 0xfc, 0x50, 0x35, 0x58, 0x46,
+  0x3d, 0xe8, 0xba, 0x31, 0x4d, 0x7c, 0x75, 0xfd, 0x80, 0x52, 0xcc, 0xf5, 0x3b, 0xae, 0x49, 0x50,
+  0xe6, 0x15, 0x67, 0x46, 0x33, 0x0a, 0xe7, 0x91, 0x4e, 0x75, 0x70, 0x8d, 0x4b, 0x59, 0x87, 0x7f,
+  0xa5, 0x24, 0x88, 0x43, 0xdd, 0x19, 0x52, 0x8f, 0xca, 0x0e, 0x29, 0x3f, 0x2d, 0xf9, 0xaf, 0x3d,
+  0x45, 0xb6, 0xa8, 0x14, 0xe9, 0x8e, 0x37, 0x2f, 0x56, 0x33, 0x73, 0x5f, 0x97, 0x40, 0x8a, 0xe5,
+  0x75, 0xc8, 0xf7, 0xf9, 0x3f, 0x7c, 0x03, 0x56, 0x49, 0xf8, 0x21, 0x27, 0x02, 0x00, 0x00,
+};
+static const char talk_html_etag[] = "\"fc5b7782f1b51e25\"";
+
+// style.css, 1674 bytes, gzip 637 bytes
+static const uint8_t style_css_gz[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95, 0x54, 0xdb, 0x6a, 0xe3, 0x30,
+  0x10, 0x7d, 0xcf, 0x57, 0x08, 0x4a, 0xa1, 0x85, 0x28, 0xd8, 0x6e, 0xb2, 0x1b, 0x6c, 0xf6, 0xa1,
+  0xbb, 0x6c, 0xd9, 0x7f, 0x58, 0xfa, 0x20, 0x5b, 0x63, 0x7b, 0xa8, 0x2c, 0x19, 0x79, 0x9c, 0xa4,
+  0x2d, 0xfd, 0xf7, 0x95, 0x64, 0xa7, 0xb9, 0xb4, 0x2e, 0x59, 0x8c, 0x4c, 0x32, 0x73, 0xe6, 0x76,
+  0xe6, 0xc8, 0x35, 0x35, 0x8a, 0xbd, 0xce, 0x18, 0x2b, 0x8d, 0x26, 0x5e, 0x8a, 0x06, 0xd5, 0x73,
+  0xca, 0xee, 0x2d, 0x0a, 0x35, 0x67, 0x7f, 0x40, 0x6d, 0x80, 0xb0, 0x10, 0x73, 0xd6, 0x09, 0xdd,
+  0xf1, 0x0e, 0x2c, 0x96, 0x19, 0x73, 0x68, 0x89, 0x5d, 0xab, 0x84, 0x43, 0xa2, 0x56, 0xa8, 0x81,
+  0xe7, 0xca, 0x14, 0x4f, 0xc1, 0x43, 0xb0, 0x23, 0x2e, 0x14, 0x56, 0x3a, 0x65, 0x05, 0x68, 0x02,
+  0x9b, 0xcd, 0xde, 0x66, 0xb3, 0x3a, 0x3e, 0x54, 0xe9, 0xf0, 0x05, 0x52, 0x16, 0x2f, 0xd6, 0x16,
+  0x9a, 0x10, 0x53, 0x18, 0x65, 0x6c, 0xca, 0xb6, 0x35, 0x12, 0x04, 0x74, 0xcb, 0x5e, 0xd9, 0x39,
+  0x7a, 0xe9, 0xd1, 0xde, 0xb9, 0x20, 0xd3, 0x6a, 0xb1, 0x19, 0x20, 0x66, 0x03, 0xb6, 0x54, 0x66,
+  0x9b, 0xb2, 0x1a, 0xa5, 0x04, 0x1d, 0xf2, 0xe5, 0xa2, 0x78, 0xaa, 0xac, 0xe9, 0xb5, 0xe4, 0x63,
+  0xea, 0xab, 0xe8, 0x3e, 0x8e, 0x93, 0x75, 0x88, 0xcf, 0x8d, 0x7c, 0x76, 0xc1, 0x1e, 0xd8, 0x08,
+  0x5b, 0xa1, 0x6b, 0x34, 0x1a, 0x12, 0x17, 0xae, 0x9e, 0x6b, 0x79, 0xc8, 0xdc, 0x0a, 0x29, 0x51,
+  0x57, 0x29, 0x5b, 0x5d, 0x8f, 0x5e, 0x61, 0x25, 0xaf, 0x2c, 0xca, 0xc1, 0xdf, 0x88, 0x1d, 0xdf,
+  0xa2, 0xa4, 0x3a, 0x65, 0xeb, 0x28, 0x6a, 0x77, 0xd9, 0x49, 0x42, 0x26, 0x7a, 0x32, 0xa7, 0x54,
+  0xf9, 0xd0, 0x60, 0xf1, 0x3f, 0x78, 0x25, 0xda, 0x94, 0x25, 0x7b, 0x06, 0x82, 0x89, 0xa0, 0x71,
+  0x48, 0x02, 0xdf, 0x74, 0xdf, 0xe8, 0x2e, 0x65, 0x16, 0x5a, 0x10, 0x74, 0xe3, 0x73, 0xf1, 0x12,
+  0x69, 0xce, 0x1a, 0xd4, 0xae, 0xee, 0xcd, 0x9d, 0x2f, 0x38, 0x67, 0x71, 0x69, 0x6f, 0x6f, 0x0f,
+  0xcd, 0x0d, 0x7d, 0x7d, 0x1c, 0x7e, 0xe0, 0x35, 0xf8, 0xcc, 0x8e, 0x77, 0xb5, 0x90, 0x9e, 0xaf,
+  0xa4, 0xdd, 0x85, 0x13, 0x87, 0x97, 0x3b, 0xb6, 0xca, 0xc5, 0x4d, 0xbc, 0x8c, 0xe6, 0xfb, 0xb3,
+  0x58, 0x1d, 0x25, 0xe7, 0x84, 0xa4, 0xe0, 0x93, 0xbd, 0x84, 0x19, 0xf6, 0xc6, 0x2d, 0x60, 0x55,
+  0x53, 0xea, 0x0a, 0x29, 0x99, 0x1d, 0x36, 0x7b, 0x15, 0xdd, 0x2d, 0xa3, 0xef, 0x6b, 0x9f, 0x0c,
+  0x75, 0xdb, 0xd3, 0x5f, 0x7a, 0x6e, 0xe1, 0x47, 0xd7, 0xe7, 0x0d, 0xd2, 0x63, 0x10, 0x46, 0x6e,
+  0xac, 0x04, 0x87, 0xd4, 0x46, 0xc3, 0x71, 0xe0, 0xc3, 0xef, 0x87, 0x5f, 0x0f, 0x3f, 0xb3, 0x89,
+  0xa5, 0x86, 0xac, 0xd9, 0xf1, 0xb2, 0xe2, 0x95, 0x9f, 0xc6, 0xbd, 0xb2, 0x09, 0x2d, 0x8e, 0x56,
+  0x09, 0x85, 0xb1, 0x82, 0xd0, 0xe8, 0x43, 0xcd, 0xcf, 0x45, 0x7d, 0x36, 0xef, 0xb7, 0x21, 0xf5,
+  0xb8, 0xf9, 0x38, 0x6c, 0xfe, 0x7d, 0xf1, 0xdc, 0x0e, 0xe3, 0xc7, 0xa3, 0x75, 0x98, 0x8a, 0x5b,
+  0x21, 0xb1, 0x77, 0xeb, 0x5c, 0x8e, 0x6d, 0x59, 0x77, 0x99, 0xd0, 0xd7, 0xe6, 0xb2, 0xdf, 0x37,
+  0x11, 0x2d, 0x96, 0x9d, 0x77, 0x7e, 0x4a, 0x51, 0x5a, 0x7b, 0x9d, 0x0f, 0x44, 0x7d, 0xa4, 0xc1,
+  0x09, 0x3b, 0xb9, 0x4f, 0xb2, 0x33, 0x76, 0xfd, 0x98, 0x8f, 0x73, 0x76, 0x64, 0xd1, 0x7d, 0x93,
+  0x83, 0x75, 0xb6, 0x0e, 0x14, 0x14, 0x14, 0xd2, 0x8d, 0x73, 0xac, 0xa2, 0xeb, 0x53, 0x1a, 0x83,
+  0x3a, 0x4e, 0x66, 0x73, 0xc6, 0xf5, 0xf0, 0x7f, 0x92, 0xa7, 0xfd, 0x12, 0xbd, 0x9a, 0x3a, 0xa3,
+  0xdc, 0x4d, 0xb9, 0x2a, 0x8a, 0x62, 0x9a, 0x88, 0x20, 0x47, 0x7c, 0x09, 0x15, 0x47, 0x84, 0x33,
+  0x85, 0x41, 0x94, 0xc8, 0x41, 0x7d, 0xfc, 0x64, 0x8c, 0x17, 0xe6, 0x6d, 0xb6, 0xd8, 0x08, 0xd5,
+  0xc3, 0xeb, 0x94, 0x18, 0xcf, 0xa8, 0x61, 0x21, 0xa4, 0x23, 0x77, 0xb9, 0xd8, 0xa5, 0x31, 0x2e,
+  0x22, 0xef, 0x89, 0x8c, 0xbe, 0x50, 0x9f, 0xa7, 0x12, 0xbc, 0x4b, 0xbe, 0x92, 0xe0, 0x05, 0x82,
+  0xfa, 0x6f, 0xe9, 0xb8, 0x01, 0x87, 0x7e, 0xf9, 0xbe, 0xe5, 0xe9, 0x0b, 0x73, 0x8c, 0xbd, 0x54,
+  0x5b, 0xef, 0x11, 0x65, 0x39, 0x05, 0x5e, 0xaf, 0xfc, 0x73, 0x06, 0xfe, 0x3a, 0x7f, 0xb2, 0x72,
+  0xcf, 0xd2, 0x85, 0xb0, 0x7f, 0xaf, 0xb3, 0x42, 0xf4, 0x8a, 0x06, 0x00, 0x00,
+};
+static const char style_css_etag[] = "\"285ac0028e69dc60\"";
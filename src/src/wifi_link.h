@@ -0,0 +1,261 @@
+/**
+ * @file wifi_link.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief WiFi station - static IP & directed reconnect to the last AP
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <Preferences.h>
+#include <esp_timer.h>
+#include <esp32/rom/crc.h>
+#include "configuration.h"
+#include "metrics.h"
+
+/**
+ * @brief WiFi station. The BSSID and channel of the last successful association
+ * are kept in RTC memory (survives reset) and in NVS (survives power cycle, written
+ * only when the AP changes), the next connect goes directly to that AP without
+ * a channel scan. If the directed connect does not succeed in time, a full scan follows,
+ * the next attempt is directed again.
+ * A lost connection is restored with exponential backoff between the attempts,
+ * the automatic reconnect of the WiFi library is off.
+ * Configuration.ip "ip[,gateway[,mask[,dns]]]" replaces DHCP, empty - DHCP.
+ *
+ */
+class WifiLink {
+private:
+    static const uint32_t _magic = 0x3AF1CAC4;
+
+    /**
+     * @brief last successful association
+     *
+     */
+    struct Cache {
+        uint32_t    magic;
+        uint32_t    ssid;           // CRC32 of SSID
+        uint8_t     bssid[6];
+        uint8_t     channel;
+        uint8_t     reserved;
+        uint32_t    crc;            // CRC32 of the preceding bytes
+    };
+
+    const Configuration*    _cfg      {nullptr};
+    Preferences             _prefs;
+    Cache                   _cache    {};
+    bool                    _cached   {false};
+    bool                    _directed {false};      // connect in progress is directed
+    bool                    _connected{false};
+    bool                    _attempt  {false};      // connect in progress
+    int64_t                 _start    {0};          // connect started [us]
+    int64_t                 _next     {0};          // next attempt [us]
+    uint32_t                _backoff  {0};          // current delay between the attempts [ms]
+
+    const char*             _ns = "wifi";
+    const char*             _key = "ap";
+    const uint32_t          _directedTimeout {4000}; // [ms]
+    const uint32_t          _attemptTimeout {15000}; // [ms]
+    const uint32_t          _minBackoff {1000};      // [ms]
+    const uint32_t          _maxBackoff {60000};     // [ms]
+
+    static Cache& rtc() {
+        static RTC_NOINIT_ATTR Cache c;
+        return c;
+    }
+
+public:
+
+    /**
+     * @brief Construct a new Wifi Link object
+     *
+     * @param cfg - ssid, password & static IP
+     */
+    explicit WifiLink(const Configuration* cfg) : _cfg(cfg) {
+    }
+
+    /**
+     * @brief start connecting, does not wait
+     *
+     * @return true - success
+     * @return false - invalid static IP or wifi start failed
+     */
+    bool init() {
+        bool rc = false;
+        do {
+            WiFi.persistent(false);
+            WiFi.setAutoReconnect(false);
+            if (!WiFi.mode(WIFI_STA)) break;
+
+            if (!_cfg->ip.isEmpty()) {
+                IPAddress ip, gateway, mask, dns;
+                if (!parseStatic(_cfg->ip, ip, gateway, mask, dns)) break;
+                if (!WiFi.config(ip, gateway, mask, dns)) break;
+            }
+
+            loadCache();
+            _backoff = _minBackoff;
+            connect(_cached);
+            rc = true;
+        } while (false);
+        return rc;
+    }
+
+    /**
+     * @brief connection supervision, call periodically from one task
+     *
+     */
+    void update() {
+        auto connected = WiFi.status() == WL_CONNECTED;
+        auto now = esp_timer_get_time();
+        do {
+            if (connected) {
+                if (_connected) break;
+                metrics().wifiAssociation.store(now - _start, std::memory_order_relaxed);
+                (_directed ? metrics().wifiDirected : metrics().wifiScanned).inc();
+                remember();
+                _attempt = false;
+                _backoff = _minBackoff;
+                break;
+            }
+
+            if (_connected) {
+                // lost, first attempt after the minimal delay
+                metrics().wifiLost.inc();
+                _attempt = false;
+                _backoff = _minBackoff;
+                _next = now + _backoff * 1000LL;
+                break;
+            }
+
+            if (_attempt) {
+                auto elapsed = (now - _start) / 1000;
+                if (_directed && elapsed > _directedTimeout) {
+                    // AP down, moved or replaced - scan this time, the cache
+                    // stays until a connect to another AP replaces it
+                    connect(false);
+                } else if (elapsed > _attemptTimeout) {
+                    // AP not available, wait longer every time
+                    WiFi.disconnect();
+                    _attempt = false;
+                    _next = now + _backoff * 1000LL;
+                    _backoff = _backoff * 2 < _maxBackoff ? _backoff * 2 : _maxBackoff;
+                }
+                break;
+            }
+
+            if (now >= _next) connect(_cached);
+        } while (false);
+        _connected = connected;
+    }
+
+    /// @brief station has IP
+    bool isConnected() const {
+        return _connected;
+    }
+
+    /**
+     * @brief static IP setting "ip[,gateway[,mask[,dns]]]", the default gateway
+     * is x.x.x.1, mask 255.255.255.0 and DNS the gateway
+     *
+     * @return true - valid
+     */
+    static bool parseStatic(const String& txt, IPAddress& ip, IPAddress& gateway, IPAddress& mask, IPAddress& dns) {
+        bool rc = false;
+        do {
+            String part[4];
+            uint8_t n = 0;
+            int from = 0;
+            while (n < 4) {
+                int comma = txt.indexOf(",", from);
+                part[n++] = txt.substring(from, comma < 0 ? txt.length() : comma);
+                if (comma < 0) break;
+                from = comma + 1;
+            }
+            for (auto& p : part) p.trim();
+
+            if (!ip.fromString(part[0])) break;
+            if (n > 1) {
+                if (!gateway.fromString(part[1])) break;
+            } else {
+                gateway = IPAddress(ip[0], ip[1], ip[2], 1);
+            }
+            if (n > 2) {
+                if (!mask.fromString(part[2])) break;
+            } else {
+                mask = IPAddress(255, 255, 255, 0);
+            }
+            if (n > 3) {
+                if (!dns.fromString(part[3])) break;
+            } else {
+                dns = gateway;
+            }
+            rc = true;
+        } while (false);
+        return rc;
+    }
+
+private:
+
+    /// @param directed - true - to the cached AP
+    void connect(bool directed) {
+        _attempt = true;
+        _directed = directed;
+        _start = esp_timer_get_time();
+        WiFi.disconnect();
+        if (directed) WiFi.begin(_cfg->ssid.c_str(), _cfg->pass.c_str(), _cache.channel, _cache.bssid);
+        else WiFi.begin(_cfg->ssid.c_str(), _cfg->pass.c_str());
+    }
+
+    static uint32_t crc(const Cache& c) {
+        return crc32_le(0, reinterpret_cast<const uint8_t*>(&c), offsetof(Cache, crc));
+    }
+
+    uint32_t ssidHash() const {
+        return crc32_le(0, reinterpret_cast<const uint8_t*>(_cfg->ssid.c_str()), _cfg->ssid.length());
+    }
+
+    bool isValid(const Cache& c) const {
+        return c.magic == _magic && c.crc == crc(c) && c.ssid == ssidHash() && c.channel > 0;
+    }
+
+    /// @brief RTC copy first, NVS after a power cycle
+    void loadCache() {
+        _cached = false;
+        if (isValid(rtc())) {
+            _cache = rtc();
+            _cached = true;
+            return;
+        }
+        if (!_prefs.begin(_ns, true)) return;
+        if (_prefs.getBytes(_key, &_cache, sizeof(_cache)) == sizeof(_cache) && isValid(_cache)) {
+            rtc() = _cache;
+            _cached = true;
+        }
+        _prefs.end();
+    }
+
+    /// @brief store the current AP, NVS only if it changed
+    void remember() {
+        Cache c {};
+        c.magic = _magic;
+        c.ssid = ssidHash();
+        memcpy(c.bssid, WiFi.BSSID(), sizeof(c.bssid));
+        c.channel = WiFi.channel();
+        c.crc = crc(c);
+        rtc() = c;
+
+        if (_cached && memcmp(&c, &_cache, sizeof(c)) == 0) return;
+        _cache = c;
+        _cached = true;
+        if (!_prefs.begin(_ns, false)) return;
+        _prefs.putBytes(_key, &c, sizeof(c));
+        _prefs.end();
+    }
+};
@@ -0,0 +1,200 @@
+/**
+ * @file zones.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Routing table of the zones - zone name to chip & relay
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <string.h>
+#include "file_sys.h"
+
+/**
+ * @brief Zones are the outputs addressed by the clients. A zone is spoken by one chip,
+ * optionally with a GPIO (relay, amplifier enable) active while the chip speaks for it.
+ * More zones may share a chip, each one with its own relay.
+ * The table is kept in /zones.txt, one zone per line "name,chip[,relay pin]", set on the configuration page.
+ * The reserved name "all" addresses every chip, the broadcast starts on all of them together.
+ *
+ */
+class ZoneTable {
+public:
+    static const uint8_t maxZones = 8;
+    static const uint8_t maxName = 15;
+    static const uint8_t anyChip = 0xFF;
+
+    /**
+     * @brief one row of the table
+     *
+     */
+    struct Zone {
+        char        name[maxName + 1];
+        uint8_t     chip;
+        int8_t      relay;          // -1 - none
+    };
+
+private:
+    Zone        _zones[maxZones];
+    uint8_t     _count {0};
+    uint8_t     _chips {1};         // number of chips
+
+    const char* _all = "all";
+
+public:
+
+    /**
+     * @brief read the table, relay pins become outputs (off)
+     *
+     * @param fs - file system
+     * @param chips - number of chips, zones of missing chips are ignored
+     * @return true - table loaded
+     * @return false - no table, only "all" & untargeted messages
+     */
+    bool init(ItemFS* fs, uint8_t chips) {
+        _chips = chips;
+        load(fs->readItem(ItemFS::Data::zones));
+        for (uint8_t i = 0; i < _count; i++) {
+            if (_zones[i].relay < 0) continue;
+            pinMode(_zones[i].relay, OUTPUT);
+            digitalWrite(_zones[i].relay, LOW);
+        }
+        return _count > 0;
+    }
+
+    /**
+     * @brief parse the text of the table, invalid lines are skipped
+     *
+     * @param txt - lines "name,chip[,relay pin]", empty lines are allowed
+     * @param chips - number of chips, 0 - as given to init()
+     * @return uint8_t - 0 - all lines valid, otherwise the first invalid line (from 1)
+     */
+    uint8_t load(const String& txt, uint8_t chips = 0) {
+        if (chips) _chips = chips;
+        _count = 0;
+        uint8_t bad = 0;
+        uint8_t line = 0;
+        int from = 0;
+        while (from < (int) txt.length()) {
+            int eol = txt.indexOf("\n", from);
+            if (eol < 0) eol = txt.length();
+            line++;
+            if (!parse(txt.substring(from, eol)) && !bad) bad = line;
+            from = eol + 1;
+        }
+        return bad;
+    }
+
+    uint8_t size() const {
+        return _count;
+    }
+
+    const Zone& zone(uint8_t i) const {
+        return _zones[i];
+    }
+
+    /**
+     * @brief chips & zones addressed by the zone name
+     *
+     * @param name - zone name, need not be zero terminated
+     * @param len - name length
+     * @param chips - out, mask of the chips
+     * @param zones - out, mask of the zones, 0 - all zones of the chips
+     * @return true - known zone
+     * @return false
+     */
+    bool resolve(const char* name, size_t len, uint8_t& chips, uint8_t& zones) const {
+        if (len == strlen(_all) && strncmp(name, _all, len) == 0) {
+            chips = (1 << _chips) - 1;
+            zones = 0;
+            return true;
+        }
+        for (uint8_t i = 0; i < _count; i++) {
+            if (strlen(_zones[i].name) != len || strncmp(_zones[i].name, name, len) != 0) continue;
+            chips = 1 << _zones[i].chip;
+            zones = 1 << i;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief relays of the chip on / off
+     *
+     * @param chip - chip index
+     * @param zones - mask of the zones, 0 - all zones of the chip
+     * @param on - true - speaking
+     */
+    void output(uint8_t chip, uint8_t zones, bool on) const {
+        for (uint8_t i = 0; i < _count; i++) {
+            if (_zones[i].chip != chip || _zones[i].relay < 0) continue;
+            if (zones && !(zones & (1 << i))) continue;
+            digitalWrite(_zones[i].relay, on ? HIGH : LOW);
+        }
+    }
+
+    /**
+     * @brief zone tag at the beginning of the text "@name text"
+     *
+     * @param text - text
+     * @param len - text length
+     * @param nameLen - out, length of the name following '@'
+     * @return size_t - length of the tag including the space, 0 - no tag
+     */
+    static size_t tag(const char* text, size_t len, size_t& nameLen) {
+        if (len < 2 || text[0] != '@') return 0;
+        nameLen = 0;
+        while (1 + nameLen < len && text[1 + nameLen] != ' ') nameLen++;
+        return 1 + nameLen < len ? 2 + nameLen : 1 + nameLen;
+    }
+
+private:
+
+    /// @brief "name,chip[,relay]", an empty line is valid and ignored
+    /// @return false - invalid line or the table is full
+    bool parse(String line) {
+        line.trim();
+        if (line.length() == 0) return true;
+        int c1 = line.indexOf(",");
+        if (c1 <= 0 || c1 > maxName || _count >= maxZones) return false;
+        int c2 = line.indexOf(",", c1 + 1);
+        long chip = 0;
+        long relay = -1;
+        if (!number(line.substring(c1 + 1, c2 < 0 ? line.length() : c2), chip) || chip >= _chips) return false;
+        if (c2 >= 0 && (!number(line.substring(c2 + 1), relay) || !isOutput(relay))) return false;
+
+        auto& z = _zones[_count];
+        strncpy(z.name, line.c_str(), c1);
+        z.name[c1] = 0;
+        if (strcmp(z.name, _all) == 0 || strchr(z.name, ' ')) return false;
+        for (uint8_t i = 0; i < _count; i++) {
+            if (strcmp(_zones[i].name, z.name) == 0) return false;
+        }
+        z.chip = chip;
+        z.relay = relay;
+        _count++;
+        return true;
+    }
+
+    /// @brief decimal number without sign, spaces around are allowed
+    static bool number(String txt, long& value) {
+        txt.trim();
+        if (txt.length() == 0 || txt.length() > 3) return false;
+        for (unsigned i = 0; i < txt.length(); i++) {
+            if (txt[i] < '0' || txt[i] > '9') return false;
+        }
+        value = txt.toInt();
+        return true;
+    }
+
+    /// @brief GPIO usable as an output - not the flash pins 6-11, not the input only pins 34-39,
+    /// not the numbers missing on the ESP32
+    static bool isOutput(long pin) {
+        return pin >= 0 && pin < 34 && (pin < 6 || pin > 11) && pin != 20 && pin != 24 && (pin < 28 || pin > 31);
+    }
+};
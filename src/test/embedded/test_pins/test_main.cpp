@@ -0,0 +1,91 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief ESP32 - CPU cycles of the pin policies, the Arduino API against the GPIO registers
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "gpio_pins.h"
+
+static const uint8_t outPin = 5;      // CS of the first chip, nothing selected while the test runs
+static const uint8_t highPin = 33;    // GPIO_OUT1 register
+static const uint8_t inPin = 34;      // RDY of the first chip
+static const uint32_t rounds = 10000;
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+/// @brief cycles of one CS assertion & release
+template <class Pins>
+static uint32_t toggle(uint8_t pin) {
+    Pins::output(pin);
+    Pins::write(pin, HIGH);
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < rounds; i++) {
+        Pins::write(pin, LOW);
+        Pins::write(pin, HIGH);
+    }
+    return (ESP.getCycleCount() - start) / rounds;
+}
+
+/// @brief cycles of one RDY poll
+template <class Pins>
+static uint32_t poll(uint8_t pin) {
+    Pins::input(pin);
+    volatile uint32_t high = 0;
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < rounds; i++) {
+        high += Pins::read(pin);
+    }
+    return (ESP.getCycleCount() - start) / rounds;
+}
+
+static void report(const char* what, uint32_t arduino, uint32_t esp32) {
+    char txt[96];
+    snprintf(txt, sizeof(txt), "%s: ArduinoPins %u cycles, Esp32Pins %u cycles", what, (unsigned) arduino, (unsigned) esp32);
+    TEST_MESSAGE(txt);
+}
+
+void test_cs_toggle() {
+    auto arduino = toggle<ArduinoPins>(outPin);
+    auto esp32 = toggle<Esp32Pins>(outPin);
+    report("CS low & high", arduino, esp32);
+    TEST_ASSERT_TRUE(esp32 < arduino);
+    TEST_ASSERT_TRUE(digitalRead(outPin) == HIGH);
+}
+
+void test_cs_toggle_high_bank() {
+    auto arduino = toggle<ArduinoPins>(highPin);
+    auto esp32 = toggle<Esp32Pins>(highPin);
+    report("GPIO 33 low & high", arduino, esp32);
+    TEST_ASSERT_TRUE(esp32 < arduino);
+}
+
+void test_rdy_poll() {
+    auto arduino = poll<ArduinoPins>(inPin);
+    auto esp32 = poll<Esp32Pins>(inPin);
+    report("RDY read", arduino, esp32);
+    TEST_ASSERT_TRUE(esp32 < arduino);
+    TEST_ASSERT_EQUAL(digitalRead(inPin) == HIGH, Esp32Pins::read(inPin));
+}
+
+void setup() {
+    delay(2000);        // the serial monitor connects
+    UNITY_BEGIN();
+    RUN_TEST(test_cs_toggle);
+    RUN_TEST(test_cs_toggle_high_bank);
+    RUN_TEST(test_rdy_poll);
+    UNITY_END();
+}
+
+void loop() {
+}
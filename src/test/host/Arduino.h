@@ -0,0 +1,151 @@
+/**
+ * @file Arduino.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build of the firmware headers - the subset of the Arduino core they use
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string>
+#include "host.h"
+#include "freertos/FreeRTOS.h"
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define MSBFIRST 1
+#define SPI_MODE3 3
+#define DEC 10
+#define HEX 16
+#define PROGMEM
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+#define IRAM_ATTR
+#define SS 5
+
+typedef uint8_t byte;
+
+inline unsigned long micros() { return static_cast<unsigned long>(host::clock().micros()); }
+inline unsigned long millis() { return static_cast<unsigned long>(host::clock().micros() / 1000); }
+inline void delay(uint32_t ms) { host::clock().sleep(ms * 1000ULL); }
+inline void delayMicroseconds(uint32_t us) { host::clock().sleep(us); }
+inline void yield() { std::this_thread::yield(); }
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t pin, uint8_t level) { host::gpio().write(pin, level != LOW); }
+inline int digitalRead(uint8_t pin) { return host::gpio().read(pin) ? HIGH : LOW; }
+
+/**
+ * @brief Arduino String over std::string
+ *
+ */
+class String {
+private:
+    std::string _s;
+
+public:
+    String() {}
+    String(const char* c) : _s(c ? c : "") {}
+    String(const std::string& c) : _s(c) {}
+    explicit String(int v) : _s(std::to_string(v)) {}
+    explicit String(unsigned v) : _s(std::to_string(v)) {}
+
+    bool isEmpty() const { return _s.empty(); }
+    unsigned length() const { return _s.size(); }
+    const char* c_str() const { return _s.c_str(); }
+    char operator[](unsigned i) const { return _s[i]; }
+    String& operator+=(char c) { _s += c; return *this; }
+    String& operator+=(const char* c) { _s += c; return *this; }
+    String& operator+=(const String& c) { _s += c._s; return *this; }
+    bool operator==(const char* c) const { return _s == c; }
+    bool operator==(const String& c) const { return _s == c._s; }
+    bool operator!=(const char* c) const { return _s != c; }
+    bool startsWith(const char* c) const { return _s.rfind(c, 0) == 0; }
+    bool endsWith(const char* c) const { size_t n = strlen(c); return _s.size() >= n && _s.compare(_s.size() - n, n, c) == 0; }
+    int indexOf(char c, unsigned from = 0) const { auto p = _s.find(c, from); return p == std::string::npos ? -1 : (int) p; }
+    int indexOf(const char* c, unsigned from = 0) const { auto p = _s.find(c, from); return p == std::string::npos ? -1 : (int) p; }
+    String substring(unsigned a, unsigned b) const { return a < b && a < _s.size() ? String(_s.substr(a, b - a)) : String(); }
+    String substring(unsigned a) const { return a < _s.size() ? String(_s.substr(a)) : String(); }
+    long toInt() const { return atol(_s.c_str()); }
+    void trim() {
+        auto b = _s.find_first_not_of(" \t\r\n");
+        auto e = _s.find_last_not_of(" \t\r\n");
+        _s = b == std::string::npos ? std::string() : _s.substr(b, e - b + 1);
+    }
+};
+
+/**
+ * @brief formatted output over write()
+ *
+ */
+class Print {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t ch) = 0;
+    virtual size_t write(const uint8_t* data, size_t len) {
+        size_t n = 0;
+        while (n < len && write(data[n])) n++;
+        return n;
+    }
+    size_t write(const char* s) { return write(reinterpret_cast<const uint8_t*>(s), strlen(s)); }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+    size_t print(unsigned long v, int base = DEC) { return printf(base == HEX ? "%lX" : "%lu", v); }
+    size_t print(long v, int base = DEC) { return base == HEX ? print(static_cast<unsigned long>(v), base) : printf("%ld", v); }
+    size_t print(unsigned v, int base = DEC) { return print(static_cast<unsigned long>(v), base); }
+    size_t print(int v, int base = DEC) { return print(static_cast<long>(v), base); }
+    template <class T>
+    size_t println(const T& v) { return print(v) + println(); }
+    size_t println() { return write("\r\n"); }
+
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        char buff[256];
+        va_list ap;
+        va_start(ap, fmt);
+        int len = vsnprintf(buff, sizeof(buff), fmt, ap);
+        va_end(ap);
+        if (len < 0) return 0;
+        return write(reinterpret_cast<const uint8_t*>(buff), (size_t) len < sizeof(buff) ? len : sizeof(buff) - 1);
+    }
+};
+
+/**
+ * @brief byte input over available() & read()
+ *
+ */
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+
+    String readString() {
+        String s;
+        int ch;
+        while ((ch = read()) >= 0) s += static_cast<char>(ch);
+        return s;
+    }
+
+    size_t readBytesUntil(char end, char* buf, size_t len) {
+        size_t n = 0;
+        int ch;
+        while (n < len && (ch = read()) >= 0 && ch != end) buf[n++] = ch;
+        return n;
+    }
+};
+
+#include "HardwareSerial.h"
@@ -0,0 +1,156 @@
+/**
+ * @file AsyncTCP.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build - AsyncTCP driven by the test, the test is the network
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <map>
+#include "Arduino.h"
+
+class AsyncClient;
+typedef std::function<void(void*, AsyncClient*)> AcConnectHandler;
+typedef std::function<void(void*, AsyncClient*, size_t len, uint32_t time)> AcAckHandler;
+typedef std::function<void(void*, AsyncClient*, void* data, size_t len)> AcDataHandler;
+typedef std::function<void(void*, AsyncClient*, uint32_t time)> AcTimeoutHandler;
+#define ASYNC_WRITE_FLAG_COPY 0x01
+
+/**
+ * @brief connection, the firmware side has the AsyncTCP API, the test side
+ * delivers data (receive), acknowledges the sent bytes (ack) and ends it (disconnect)
+ *
+ */
+class AsyncClient {
+private:
+    AcDataHandler       _onData;
+    AcConnectHandler    _onDisconnect;
+    AcAckHandler        _onAck;
+    AcConnectHandler    _onPoll;
+    AcTimeoutHandler    _onTimeout;
+    void*               _dataArg {nullptr};
+    void*               _disconnectArg {nullptr};
+    void*               _ackArg {nullptr};
+    void*               _pollArg {nullptr};
+    size_t              _window;
+    size_t              _unacked {0};
+    bool                _closed {false};
+
+public:
+    std::string         sent;       ///> everything written by the firmware
+
+    /// @param window - TCP send buffer [bytes]
+    explicit AsyncClient(size_t window = 5744) : _window(window) {}
+
+    void onData(AcDataHandler cb, void* arg = nullptr) { _onData = cb; _dataArg = arg; }
+    void onDisconnect(AcConnectHandler cb, void* arg = nullptr) { _onDisconnect = cb; _disconnectArg = arg; }
+    void onAck(AcAckHandler cb, void* arg = nullptr) { _onAck = cb; _ackArg = arg; }
+    void onPoll(AcConnectHandler cb, void* arg = nullptr) { _onPoll = cb; _pollArg = arg; }
+    void onTimeout(AcTimeoutHandler cb, void* = nullptr) { _onTimeout = cb; }
+    void setNoDelay(bool) {}
+
+    size_t space() const {
+        return _closed ? 0 : _window - _unacked;
+    }
+
+    size_t add(const char* data, size_t size, uint8_t = ASYNC_WRITE_FLAG_COPY) {
+        size_t n = size < space() ? size : space();
+        sent.append(data, n);
+        _unacked += n;
+        return n;
+    }
+
+    bool send() {
+        return !_closed;
+    }
+
+    size_t write(const char* data, size_t size, uint8_t flags = ASYNC_WRITE_FLAG_COPY) {
+        auto n = add(data, size, flags);
+        send();
+        return n;
+    }
+
+    size_t write(const char* data) {
+        return write(data, strlen(data));
+    }
+
+    /// @brief closed by the firmware, the test calls disconnect() as the stack would
+    void close(bool = false) {
+        _closed = true;
+    }
+
+    bool closed() const {
+        return _closed;
+    }
+
+    /// @brief test side - data from the peer
+    void receive(const char* data, size_t len) {
+        if (_onData && !_closed) _onData(_dataArg, this, const_cast<char*>(data), len);
+    }
+
+    /// @brief test side - the peer acknowledged the sent bytes
+    void ack(size_t len) {
+        if (len > _unacked) len = _unacked;
+        _unacked -= len;
+        if (_onAck) _onAck(_ackArg, this, len, 0);
+    }
+
+    /// @brief test side - periodic poll of the stack
+    void poll() {
+        if (_onPoll) _onPoll(_pollArg, this);
+    }
+
+    /// @brief test side - the connection is gone, the firmware usually deletes the client
+    void disconnect() {
+        if (_onDisconnect) _onDisconnect(_disconnectArg, this);
+    }
+};
+
+/**
+ * @brief listener, at() & connect() are the test side
+ *
+ */
+class AsyncServer {
+private:
+    AcConnectHandler    _onClient;
+    void*               _arg {nullptr};
+    uint16_t            _port;
+
+    static std::map<uint16_t, AsyncServer*>& ports() {
+        static std::map<uint16_t, AsyncServer*> p;
+        return p;
+    }
+
+public:
+    explicit AsyncServer(uint16_t port) : _port(port) {
+        ports()[port] = this;
+    }
+
+    ~AsyncServer() {
+        ports().erase(_port);
+    }
+
+    /// @brief test side - server listening on the port, nullptr - none
+    static AsyncServer* at(uint16_t port) {
+        auto s = ports().find(port);
+        return s == ports().end() ? nullptr : s->second;
+    }
+
+    void onClient(AcConnectHandler cb, void* arg) { _onClient = cb; _arg = arg; }
+    void begin() {}
+    void end() {}
+    void setNoDelay(bool) {}
+
+    /// @brief test side - new connection, owned by the firmware like the real one
+    AsyncClient* connect(size_t window = 5744) {
+        auto c = new AsyncClient(window);
+        if (_onClient) _onClient(_arg, c);
+        return c;
+    }
+};
@@ -0,0 +1,81 @@
+/**
+ * @file FS.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build - file system in memory
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include "Arduino.h"
+
+#define FILE_WRITE "w"
+#define FILE_READ "r"
+
+namespace fs {
+
+/**
+ * @brief open file, the content is shared with the file system
+ *
+ */
+class File : public Stream {
+private:
+    std::shared_ptr<std::string> _data;
+    std::string _name;
+    size_t _pos {0};
+
+public:
+    File() {}
+    File(std::shared_ptr<std::string> data, const std::string& name) : _data(data), _name(name) {}
+
+    explicit operator bool() const { return _data != nullptr; }
+    void close() { _data.reset(); }
+    const char* name() const { return _name.c_str(); }
+    size_t size() const { return _data ? _data->size() : 0; }
+    File openNextFile() { return File(); }
+
+    int available() override { return _data ? _data->size() - _pos : 0; }
+    int read() override { return _data && _pos < _data->size() ? static_cast<uint8_t>((*_data)[_pos++]) : -1; }
+
+    using Print::write;
+    size_t write(uint8_t ch) override {
+        if (!_data) return 0;
+        _data->push_back(ch);
+        return 1;
+    }
+};
+
+/**
+ * @brief files by path
+ *
+ */
+class FS {
+private:
+    std::map<std::string, std::shared_ptr<std::string>> _files;
+
+public:
+    File open(const char* path, const char* mode = FILE_READ) {
+        if (strcmp(mode, FILE_WRITE) == 0) _files[path] = std::make_shared<std::string>();
+        auto f = _files.find(path);
+        return f == _files.end() ? File() : File(f->second, path);
+    }
+
+    bool exists(const char* path) {
+        return _files.count(path) > 0;
+    }
+
+    bool remove(const char* path) {
+        return _files.erase(path) > 0;
+    }
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
@@ -0,0 +1,102 @@
+/**
+ * @file HardwareSerial.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build - UART over a file descriptor, e.g. the slave side of a pty
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include "Arduino.h"
+
+/**
+ * @brief UART of the host build. Without attach() it is a sink, the output is discarded.
+ * The receive "ring buffer" is the kernel buffer of the descriptor, onReceive() is called
+ * from a reader thread whenever bytes are waiting, like the UART event task does.
+ *
+ */
+class HardwareSerial : public Stream {
+private:
+    int             _fd {-1};
+    std::function<void(void)> _onReceive;
+    std::thread     _events;
+    std::atomic<bool> _running {false};
+
+public:
+    ~HardwareSerial() {
+        end();
+    }
+
+    /// @brief host only, the UART reads & writes the descriptor
+    void attach(int fd) {
+        end();
+        _fd = fd;
+        fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    void begin(unsigned long, uint32_t = 0, int8_t = -1, int8_t = -1) {
+        if (_fd < 0 || _running) return;
+        _running = true;
+        _events = std::thread([this] () {
+            while (_running) {
+                pollfd p { _fd, POLLIN, 0 };
+                if (poll(&p, 1, 10) > 0 && (p.revents & POLLIN) && _onReceive) {
+                    _onReceive();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        });
+    }
+
+    void end() {
+        _running = false;
+        if (_events.joinable()) _events.join();
+    }
+
+    size_t setRxBufferSize(size_t n) { return n; }
+    bool setPins(int8_t, int8_t, int8_t = -1, int8_t = -1) { return true; }
+    bool setHwFlowCtrlMode(uint8_t = 3, uint8_t = 64) { return true; }
+    void onReceive(std::function<void(void)> function) { _onReceive = function; }
+    void flush() {}
+
+    int available() override {
+        int n = 0;
+        if (_fd < 0 || ioctl(_fd, FIONREAD, &n) < 0) return 0;
+        return n;
+    }
+
+    int read() override {
+        uint8_t ch;
+        return _fd >= 0 && ::read(_fd, &ch, 1) == 1 ? ch : -1;
+    }
+
+    int availableForWrite() {
+        return 128;
+    }
+
+    using Print::write;
+    size_t write(uint8_t ch) override {
+        return write(&ch, 1);
+    }
+
+    size_t write(const uint8_t* data, size_t len) override {
+        if (_fd < 0) return len;
+        size_t n = 0;
+        while (n < len) {
+            auto w = ::write(_fd, data + n, len - n);
+            if (w > 0) n += w;
+            else std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return n;
+    }
+};
+
+inline HardwareSerial Serial;
@@ -0,0 +1,58 @@
+/**
+ * @file SPI.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build - SPI master on the simulated bus, see host::SpiBus
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+#define VSPI 3
+#define HSPI 2
+
+class SPISettings {
+public:
+    SPISettings() {}
+    SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+class SPIClass {
+private:
+    int8_t  _ss {SS};
+
+public:
+    explicit SPIClass(uint8_t = VSPI) {}
+
+    void begin(int8_t = -1, int8_t = -1, int8_t = -1, int8_t ss = -1) {
+        if (ss >= 0) _ss = ss;
+    }
+    void beginTransaction(SPISettings) {}
+    void endTransaction() {}
+
+    uint8_t transfer(uint8_t data) {
+        return host::spiBus().transfer(data);
+    }
+
+    void transferBytes(const uint8_t* data, uint8_t* out, uint32_t size) {
+        for (uint32_t i = 0; i < size; i++) {
+            uint8_t ch = transfer(data ? data[i] : 0xFF);
+            if (out) out[i] = ch;
+        }
+    }
+
+    void writeBytes(const uint8_t* data, uint32_t size) {
+        transferBytes(data, nullptr, size);
+    }
+
+    void setHwCs(bool) {}
+
+    int8_t pinSS() {
+        return _ss;
+    }
+};
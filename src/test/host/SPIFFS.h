@@ -0,0 +1,22 @@
+/**
+ * @file SPIFFS.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build - SPIFFS in memory
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include "FS.h"
+
+class SPIFFSFS : public fs::FS {
+public:
+    bool begin(bool = false) { return true; }
+    void end() {}
+};
+
+inline SPIFFSFS SPIFFS;
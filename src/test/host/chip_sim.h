@@ -0,0 +1,350 @@
+/**
+ * @file chip_sim.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build - simulated S1V30120 on the SPI bus with fault injection
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <thread>
+#include "host.h"
+#include "esp32/rom/crc.h"
+#include "S1V30120_const.h"
+#include "S1V30120_init_data.h"
+
+namespace host {
+
+/**
+ * @brief S1V30120 as the driver sees it: ISC messages after 0xAA while CS is low,
+ * RDY high when a response waits, the response read after 0xAA in the next selection.
+ * The boot loader checks the CRC of the uploaded image, the TTS "speaks" for a time
+ * given by the text length and then indicates the end.
+ *
+ * Faults are planned by the number of the response (0 - the next one):
+ *  - dropRdy  - the response is queued, RDY never rises (lost edge)
+ *  - garbage  - noise bytes before the 0xAA of the response, > 256 loses the sync
+ *  - reject   - the request is answered with an error code (e.g. a firmware block)
+ *  - errorInd - ISC_ERROR_IND instead of the response
+ *
+ */
+class ChipSim : public SpiDevice {
+public:
+    enum class Fault : uint8_t { dropRdy, garbage, reject, errorInd };
+
+    static constexpr uint16_t hwVersion = 0x0402;
+    static constexpr uint16_t fwVersion = 0x0206;
+
+private:
+    struct Response {
+        std::vector<uint8_t> bytes;
+        uint16_t    noise  {0};         // garbage bytes before 0xAA
+        bool        silent {false};     // RDY is not raised
+    };
+
+    struct Plan {
+        Fault       fault;
+        uint32_t    from;               // first affected response
+        uint32_t    to;                 // behind the last one
+        uint16_t    noise;
+    };
+
+    const uint8_t   _cs;
+    const uint8_t   _rst;
+    const uint8_t   _rdy;
+    uint32_t        _usPerChar;         // speech duration
+
+    std::mutex      _mtx;
+    std::atomic<bool> _selected {false};
+    bool            _reset    {false};
+    bool            _reading  {false};  // selection reads a response
+    bool            _started  {false};  // 0xAA of the request received
+    size_t          _pos      {0};      // read position of the selection
+    std::vector<uint8_t> _in;           // request of the selection
+    std::deque<Response> _out;          // responses waiting for the host
+    std::vector<Plan> _plans;
+    uint32_t        _responses{0};      // responses produced since the creation
+
+    bool            _running  {false};  // firmware started
+    uint32_t        _crc      {0};      // of the uploaded image
+    uint64_t        _finishAt {0};      // end of the utterance [us], 0 - silent
+
+    std::atomic<bool> _alive {true};
+    std::thread     _timer;
+
+public:
+    // observed by the tests
+    std::atomic<uint32_t> resets {0};
+    std::atomic<uint32_t> blocks {0};        // accepted firmware blocks
+    std::atomic<uint32_t> stops {0};
+    std::atomic<uint32_t> volumes {0};
+    std::atomic<int16_t>  volume {0};
+    std::atomic<uint32_t> finished {0};      // utterances spoken to the end
+    std::vector<std::string> spoken;         // texts of the speak requests, read when idle
+    std::thread::id commandThread;           // thread of the last stop / volume request
+
+    /**
+     * @brief Construct a new chip on the bus
+     *
+     * @param cs - chip select pin
+     * @param rst - reset pin
+     * @param rdy - ready pin, driven by the chip
+     * @param usPerChar - speech duration per character [us]
+     */
+    ChipSim(uint8_t cs, uint8_t rst, uint8_t rdy, uint32_t usPerChar = 5000) : _cs(cs), _rst(rst), _rdy(rdy), _usPerChar(usPerChar) {
+        gpio().drive(_cs, true);
+        gpio().watch(_cs, [this] (uint8_t, bool level) { select(!level); });
+        gpio().watch(_rst, [this] (uint8_t, bool level) { reset(!level); });
+        spiBus().attach(this);
+        _timer = std::thread([this] () {
+            while (_alive) {
+                tick();
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        });
+    }
+
+    ~ChipSim() {
+        _alive = false;
+        _timer.join();
+        spiBus().detach(this);
+        gpio().watch(_cs, nullptr);
+        gpio().watch(_rst, nullptr);
+    }
+
+    /**
+     * @brief plan a fault
+     *
+     * @param fault - kind
+     * @param after - responses before the first affected one
+     * @param count - affected responses
+     * @param noise - garbage bytes, Fault::garbage only
+     */
+    void inject(Fault fault, uint32_t after = 0, uint32_t count = 1, uint16_t noise = 16) {
+        std::lock_guard<std::mutex> lck(_mtx);
+        _plans.push_back({ fault, _responses + after, _responses + after + count, noise });
+    }
+
+    /// @brief firmware uploaded with the valid CRC and started
+    bool isRunning() {
+        std::lock_guard<std::mutex> lck(_mtx);
+        return _running;
+    }
+
+    bool selected() const override {
+        return _selected;
+    }
+
+    uint8_t exchange(uint8_t mosi) override {
+        std::lock_guard<std::mutex> lck(_mtx);
+        if (_reading) {
+            if (_out.empty()) return 0x00;
+            auto& r = _out.front();
+            size_t pos = _pos++;
+            if (pos < r.noise) return 0x55 ^ (pos & 0x0F);
+            if (pos == r.noise) return 0xAA;
+            pos -= r.noise + 1;
+            return pos < r.bytes.size() ? r.bytes[pos] : 0x00;
+        }
+        if (_started) _in.push_back(mosi);
+        else if (mosi == 0xAA) _started = true;
+        return 0x00;
+    }
+
+private:
+
+    /// @brief CS edge
+    void select(bool low) {
+        std::lock_guard<std::mutex> lck(_mtx);
+        if (_reset) return;
+        if (low) {
+            _reading = isRdy();
+            _started = false;
+            _pos = 0;
+            _in.clear();
+            _selected = true;
+            return;
+        }
+
+        if (!_selected) return;        // CS high written again
+        _selected = false;
+        if (_reading) {
+            // the whole header & result read
+            if (!_out.empty() && _pos >= _out.front().noise + 1u + 6u) _out.pop_front();
+        } else {
+            request(_in);
+        }
+        _reading = false;
+        updateRdy();
+    }
+
+    /// @brief RESET pin
+    void reset(bool active) {
+        std::lock_guard<std::mutex> lck(_mtx);
+        if (active && !_reset) resets++;
+        _reset = active;
+        _out.clear();
+        _running = false;
+        _crc = 0;
+        _finishAt = 0;
+        _selected = false;
+        updateRdy();
+    }
+
+    /// @brief end of the utterance
+    void tick() {
+        std::lock_guard<std::mutex> lck(_mtx);
+        if (!_finishAt || clock().micros() < _finishAt) return;
+        _finishAt = 0;
+        finished++;
+        respond(ISC_TTS_FINISHED_IND, 0x0000);
+        if (!_selected) updateRdy();
+    }
+
+    bool isRdy() const {
+        return !_reset && !_out.empty() && !_out.front().silent;
+    }
+
+    void updateRdy() {
+        gpio().drive(_rdy, isRdy());
+    }
+
+    /// @brief one request, locked
+    void request(const std::vector<uint8_t>& msg) {
+        if (msg.size() < 4) return;
+        size_t len = msg[0] | (msg[1] << 8);
+        uint16_t id = msg[2] | (msg[3] << 8);
+        if (len < 4 || msg.size() < len) return;       // broken transfer, no answer
+        const uint8_t* payload = msg.data() + 4;
+        size_t size = len - 4;
+
+        switch (id) {
+            case ISC_VERSION_REQ: {
+                Response r;
+                r.bytes.assign(20, 0);
+                r.bytes[0] = 20;
+                r.bytes[2] = ISC_VERSION_RESP & 0xFF;
+                r.bytes[3] = ISC_VERSION_RESP >> 8;
+                r.bytes[4] = hwVersion >> 8;
+                r.bytes[5] = hwVersion & 0xFF;
+                r.bytes[6] = _running ? fwVersion >> 8 : 0;
+                r.bytes[7] = _running ? fwVersion & 0xFF : 0;
+                push(r, false);
+                break;
+            }
+
+            case ISC_BOOT_LOAD_REQ:
+                if (_running) {
+                    respond(ISC_MSG_BLOCKED_RESP, 0x0000);
+                } else if (!respond(ISC_BOOT_LOAD_RESP, 0x0001, true)) {
+                    _crc = crc32_le(_crc, payload, size);
+                    blocks++;
+                }
+                break;
+
+            case ISC_BOOT_RUN_REQ:
+                // the boot loader refuses a corrupted image
+                if (_crc != S1V30120_INIT_DATA_CRC) {
+                    respond(ISC_ERROR_IND, 0x0000);
+                    break;
+                }
+                _running = true;
+                respond(ISC_BOOT_RUN_RESP, 0x0001);
+                break;
+
+            case ISC_TEST_REQ:        configured(ISC_TEST_RESP); break;
+            case ISC_AUDIO_CONFIG_REQ: configured(ISC_AUDIO_CONFIG_RESP); break;
+            case ISC_TTS_CONFIG_REQ:  configured(ISC_TTS_CONFIG_RESP); break;
+
+            case ISC_AUDIO_VOLUME_REQ:
+                volumes++;
+                volume = static_cast<int16_t>(payload[0] | (payload[1] << 8));
+                commandThread = std::this_thread::get_id();
+                configured(ISC_AUDIO_VOLUME_RESP);
+                break;
+
+            case ISC_TTS_SPEAK_REQ:
+                if (!_running) {
+                    respond(ISC_MSG_BLOCKED_RESP, 0x0000);
+                    break;
+                }
+                if (!respond(ISC_TTS_SPEAK_RESP, 0x0000, true)) {
+                    std::string text(reinterpret_cast<const char*>(payload + 1), size - 2);
+                    spoken.push_back(text);
+                    _finishAt = clock().micros() + text.size() * _usPerChar;
+                }
+                break;
+
+            case ISC_TTS_STOP_REQ:
+                stops++;
+                commandThread = std::this_thread::get_id();
+                respond(ISC_TTS_STOP_RESP, 0x0000);
+                if (_finishAt) {
+                    _finishAt = 0;
+                    respond(ISC_TTS_FINISHED_IND, 0x0000);
+                }
+                break;
+
+            default:
+                respond(ISC_MSG_BLOCKED_RESP, 0x0000);
+                break;
+        }
+    }
+
+    /// @brief response of a configuration request, only the running firmware accepts it
+    void configured(uint16_t id) {
+        respond(_running ? id : ISC_MSG_BLOCKED_RESP, 0x0000);
+    }
+
+    /**
+     * @brief queue the response with the planned faults
+     *
+     * @param reject - true - Fault::reject changes the result code
+     * @return true - rejected
+     */
+    bool respond(uint16_t id, uint16_t code, bool reject = false) {
+        bool rejected = reject && planned(Fault::reject);
+        if (rejected) code = ~code;
+        if (planned(Fault::errorInd)) id = ISC_ERROR_IND;
+
+        Response r;
+        r.bytes = { 6, 0, static_cast<uint8_t>(id & 0xFF), static_cast<uint8_t>(id >> 8),
+                    static_cast<uint8_t>(code & 0xFF), static_cast<uint8_t>(code >> 8) };
+        push(r, true);
+        return rejected;
+    }
+
+    /// @brief into the output queue, the plans checked already for an ISC response
+    void push(Response& r, bool checked) {
+        if (!checked && planned(Fault::errorInd)) {
+            r.bytes.resize(6);
+            r.bytes[0] = 6;
+            r.bytes[2] = ISC_ERROR_IND & 0xFF;
+            r.bytes[3] = ISC_ERROR_IND >> 8;
+        }
+        for (auto& p : _plans) {
+            if (_responses < p.from || _responses >= p.to) continue;
+            if (p.fault == Fault::dropRdy) r.silent = true;
+            if (p.fault == Fault::garbage) r.noise = p.noise;
+        }
+        _responses++;
+        _out.push_back(r);
+    }
+
+    /// @brief fault planned for the response being built
+    bool planned(Fault f) const {
+        for (auto& p : _plans) {
+            if (p.fault == f && _responses >= p.from && _responses < p.to) return true;
+        }
+        return false;
+    }
+};
+
+} // namespace host
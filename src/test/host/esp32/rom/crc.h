@@ -0,0 +1,24 @@
+/**
+ * @file crc.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build - CRC of the ESP32 ROM
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/// @brief CRC-32 (IEEE 802.3, reflected), the same value as zlib crc32()
+inline uint32_t crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (uint8_t b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
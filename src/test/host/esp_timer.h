@@ -0,0 +1,18 @@
+/**
+ * @file esp_timer.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build - high resolution timer
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include "host.h"
+
+inline int64_t esp_timer_get_time() {
+    return static_cast<int64_t>(host::clock().micros());
+}
@@ -0,0 +1,164 @@
+/**
+ * @file FreeRTOS.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build - FreeRTOS tasks, notifications & event groups over std::thread
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "../host.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t EventBits_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdMS_TO_TICKS(x) (x)
+#define portMAX_DELAY 0xffffffffUL
+#define portTICK_PERIOD_MS 1
+
+namespace host {
+
+/**
+ * @brief task with its notification value
+ *
+ */
+struct Task {
+    std::mutex              mtx;
+    std::condition_variable cv;
+    uint32_t                notified {0};
+    std::thread             thread;
+};
+
+/// @brief task bound to the calling thread
+inline Task*& boundTask() {
+    thread_local Task* self = nullptr;
+    return self;
+}
+
+/// @brief task of the calling thread, created on the first use (test main, std::thread)
+inline Task* currentTask() {
+    auto& self = boundTask();
+    if (!self) self = new Task();
+    return self;
+}
+
+} // namespace host
+
+typedef host::Task* TaskHandle_t;
+
+/**
+ * @brief event group - bits & waiters
+ *
+ */
+struct HostEventGroup {
+    std::mutex              mtx;
+    std::condition_variable cv;
+    EventBits_t             bits {0};
+};
+typedef HostEventGroup* EventGroupHandle_t;
+
+inline BaseType_t xPortGetCoreID() {
+    return 0;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return host::currentTask();
+}
+
+inline void vTaskDelay(TickType_t ticks) {
+    host::clock().sleep(ticks * 1000ULL);
+}
+
+inline TickType_t xTaskGetTickCount() {
+    return static_cast<TickType_t>(host::clock().micros() / 1000);
+}
+
+inline void vTaskDelayUntil(TickType_t* wake, TickType_t period) {
+    *wake += period;
+    int32_t left = static_cast<int32_t>(*wake - xTaskGetTickCount());
+    if (left > 0) vTaskDelay(left);
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    auto t = host::currentTask();
+    std::unique_lock<std::mutex> lck(t->mtx);
+    if (ticks == portMAX_DELAY) t->cv.wait(lck, [t] { return t->notified > 0; });
+    else t->cv.wait_for(lck, host::clock().real(ticks * 1000ULL), [t] { return t->notified > 0; });
+    uint32_t v = t->notified;
+    if (v) t->notified = clear ? 0 : v - 1;
+    return v;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    if (!task) return pdFALSE;
+    {
+        std::lock_guard<std::mutex> lck(task->mtx);
+        task->notified++;
+    }
+    task->cv.notify_all();
+    return pdPASS;
+}
+
+/// @brief the thread runs until the process ends, a host task never returns either
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* arg, UBaseType_t,
+                                          TaskHandle_t* handle, BaseType_t) {
+    auto task = new host::Task();
+    task->thread = std::thread([fn, arg, task] () {
+        host::boundTask() = task;
+        fn(arg);
+    });
+    task->thread.detach();
+    if (handle) *handle = task;
+    return pdPASS;
+}
+
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) {
+    return 0;
+}
+
+inline EventGroupHandle_t xEventGroupCreate() {
+    return new HostEventGroup();
+}
+
+inline EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits) {
+    std::lock_guard<std::mutex> lck(g->mtx);
+    g->bits |= bits;
+    g->cv.notify_all();
+    return g->bits;
+}
+
+inline EventBits_t xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits) {
+    std::lock_guard<std::mutex> lck(g->mtx);
+    auto prev = g->bits;
+    g->bits &= ~bits;
+    return prev;
+}
+
+inline EventBits_t xEventGroupGetBits(EventGroupHandle_t g) {
+    std::lock_guard<std::mutex> lck(g->mtx);
+    return g->bits;
+}
+
+inline EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t clear, BaseType_t all, TickType_t ticks) {
+    std::unique_lock<std::mutex> lck(g->mtx);
+    auto done = [g, bits, all] { return all ? (g->bits & bits) == bits : (g->bits & bits) != 0; };
+    if (ticks == portMAX_DELAY) g->cv.wait(lck, done);
+    else g->cv.wait_for(lck, host::clock().real(ticks * 1000ULL), done);
+    auto rc = g->bits;
+    if (clear && done()) g->bits &= ~bits;
+    return rc;
+}
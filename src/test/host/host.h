@@ -0,0 +1,188 @@
+/**
+ * @file host.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build of the firmware headers - simulated time, GPIO & SPI bus
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <functional>
+
+namespace host {
+
+/**
+ * @brief Time of the simulation. Runs with the real clock multiplied by the speedup,
+ * so the protocol delays (200 ms CS setup, 150 ms reset ...) keep their proportions
+ * and a test of many utterances takes seconds. millis(), delay() and the FreeRTOS
+ * ticks are all derived from it.
+ *
+ */
+class Clock {
+private:
+    std::chrono::steady_clock::time_point _start {std::chrono::steady_clock::now()};
+    std::atomic<uint32_t> _speedup {1};
+    std::atomic<uint64_t> _offset {0};
+
+public:
+    /// @brief simulated time runs n times faster than the real one
+    void speedup(uint32_t n) {
+        _speedup = n ? n : 1;
+    }
+
+    uint32_t speedup() const {
+        return _speedup;
+    }
+
+    /// @brief the simulated time jumps forward, e.g. to expire a long timeout
+    void advance(uint64_t us) {
+        _offset += us;
+    }
+
+    /// @brief simulated time [us]
+    uint64_t micros() const {
+        auto real = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _start).count();
+        return static_cast<uint64_t>(real) * _speedup + _offset;
+    }
+
+    /// @brief sleep for the simulated time [us]
+    void sleep(uint64_t us) const {
+        std::this_thread::sleep_for(std::chrono::microseconds(us / _speedup));
+    }
+
+    /// @brief real time for the simulated one, e.g. a condition variable timeout
+    std::chrono::microseconds real(uint64_t us) const {
+        return std::chrono::microseconds(us / _speedup);
+    }
+};
+
+inline Clock& clock() {
+    static Clock c;
+    return c;
+}
+
+/**
+ * @brief GPIO levels, a simulated device watches its input pins and drives its outputs
+ *
+ */
+class Gpio {
+public:
+    static const uint8_t pins = 64;
+    using Watch = std::function<void(uint8_t pin, bool level)>;
+
+private:
+    std::atomic<bool> _level[pins] {};
+    std::atomic<uint32_t> _writes {0};
+    Watch _watch[pins];
+
+public:
+    /// @brief call the watch on every write of the pin, set up before the test starts
+    void watch(uint8_t pin, Watch w) {
+        _watch[pin % pins] = w;
+    }
+
+    /// @brief written by the firmware
+    void write(uint8_t pin, bool level) {
+        _level[pin % pins] = level;
+        _writes++;
+        if (_watch[pin % pins]) _watch[pin % pins](pin, level);
+    }
+
+    /// @brief driven by a simulated device, no watch
+    void drive(uint8_t pin, bool level) {
+        _level[pin % pins] = level;
+    }
+
+    bool read(uint8_t pin) const {
+        return _level[pin % pins];
+    }
+
+    uint32_t writes() const {
+        return _writes;
+    }
+};
+
+inline Gpio& gpio() {
+    static Gpio g;
+    return g;
+}
+
+/**
+ * @brief device on the simulated SPI bus
+ *
+ */
+class SpiDevice {
+public:
+    virtual ~SpiDevice() = default;
+    /// @brief the device answers the transfers now (its CS is low)
+    virtual bool selected() const = 0;
+    /// @brief one full duplex byte
+    virtual uint8_t exchange(uint8_t mosi) = 0;
+};
+
+/**
+ * @brief devices sharing the bus, MISO of a bus with no selected device is pulled up
+ *
+ */
+class SpiBus {
+public:
+    static const uint8_t maxDevices = 8;
+
+private:
+    std::mutex  _mtx;
+    SpiDevice*  _devices[maxDevices] {};
+    uint32_t    _collisions {0};
+
+public:
+    void attach(SpiDevice* dev) {
+        std::lock_guard<std::mutex> lck(_mtx);
+        for (auto& d : _devices) {
+            if (!d) {
+                d = dev;
+                return;
+            }
+        }
+    }
+
+    void detach(SpiDevice* dev) {
+        std::lock_guard<std::mutex> lck(_mtx);
+        for (auto& d : _devices) {
+            if (d == dev) d = nullptr;
+        }
+    }
+
+    uint8_t transfer(uint8_t mosi) {
+        std::lock_guard<std::mutex> lck(_mtx);
+        uint8_t miso = 0xFF;
+        uint8_t n = 0;
+        for (auto d : _devices) {
+            if (d && d->selected()) {
+                miso &= d->exchange(mosi);
+                n++;
+            }
+        }
+        if (n > 1) _collisions++;
+        return miso;
+    }
+
+    /// @brief transfers with more than one chip selected, the firmware must keep it 0
+    uint32_t collisions() const {
+        return _collisions;
+    }
+};
+
+inline SpiBus& spiBus() {
+    static SpiBus b;
+    return b;
+}
+
+} // namespace host
@@ -0,0 +1,53 @@
+/**
+ * @file host_pins.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build - pin policy of the S1V30120 driver on the simulated GPIO
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include "host.h"
+
+/**
+ * @brief Pin policy like Esp32Pins, straight to the simulated GPIO without the Arduino API,
+ * every access is counted per pin, so the tests see what one ISC message costs on the pins.
+ *
+ */
+struct HostPins {
+    static std::atomic<uint32_t>* writes() {
+        static std::atomic<uint32_t> w[host::Gpio::pins] {};
+        return w;
+    }
+
+    static std::atomic<uint32_t>* reads() {
+        static std::atomic<uint32_t> r[host::Gpio::pins] {};
+        return r;
+    }
+
+    /// @brief counters to zero
+    static void clear() {
+        for (uint8_t i = 0; i < host::Gpio::pins; i++) {
+            writes()[i] = 0;
+            reads()[i] = 0;
+        }
+    }
+
+    static void output(uint8_t) {}
+    static void input(uint8_t) {}
+
+    static void write(uint8_t pin, bool level) {
+        writes()[pin % host::Gpio::pins]++;
+        host::gpio().write(pin, level);
+    }
+
+    static bool read(uint8_t pin) {
+        reads()[pin % host::Gpio::pins]++;
+        return host::gpio().read(pin);
+    }
+};
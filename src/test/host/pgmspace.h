@@ -0,0 +1,16 @@
+/**
+ * @file pgmspace.h
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Host build - flash data are ordinary constants
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+#define pgm_read_byte(x) (*(const uint8_t*)(x))
@@ -0,0 +1,191 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief S1V30120 driver against the simulated chip - recovery from dropped RDY edges,
+ * garbage bytes, rejected blocks & ISC_ERROR_IND
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <unity.h>
+#include <chrono>
+#include "chip_sim.h"
+#include "S1V30120.h"
+
+using host::ChipSim;
+
+static const uint8_t csPin = 5;
+static const uint8_t rstPin = 13;
+static const uint8_t rdyPin = 34;
+static const uint8_t mutePin = 12;
+static const uint32_t speedup = 20;         // the 1 s RDY deadline takes 50 ms
+
+static SPIClass spi;
+static ChipSim* sim = nullptr;
+static S1V30120* chip = nullptr;
+
+void setUp() {
+    sim = new ChipSim(csPin, rstPin, rdyPin);
+    chip = new S1V30120(&spi, rstPin, rdyPin, mutePin, csPin);
+}
+
+void tearDown() {
+    delete chip;
+    delete sim;
+}
+
+/// @brief speak and wait for the end of the utterance like the synthesizer task
+static bool speak(const char* text, uint32_t timeout = 10000) {
+    if (!chip->speak(text, strlen(text), false, true)) return false;
+    auto start = millis();
+    while (!chip->isFinished()) {
+        if (chip->isFaulted() || millis() - start > timeout) return false;
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return true;
+}
+
+/// @brief the synthesizer task: a failed utterance re-initializes the chip and is spoken again
+/// @return attempts needed
+static uint32_t speakRecovered(const char* text) {
+    uint32_t attempts = 1;
+    while (!speak(text)) {
+        attempts++;
+        while (!chip->init()) attempts++;
+    }
+    return attempts;
+}
+
+/// @brief init time [ms of the simulated clock] as the text of the test log
+static void report(const char* what, uint64_t startUs) {
+    char txt[96];
+    snprintf(txt, sizeof(txt), "%s: recovered in %u ms", what, (unsigned) ((host::clock().micros() - startUs) / 1000));
+    TEST_MESSAGE(txt);
+}
+
+void test_init_and_speak() {
+    TEST_ASSERT_TRUE(chip->init());
+    TEST_ASSERT_TRUE(sim->isRunning());
+    TEST_ASSERT_EQUAL(ChipSim::hwVersion, chip->getHWVersion());
+    TEST_ASSERT_EQUAL(ChipSim::fwVersion, chip->getFWVersion());
+    TEST_ASSERT_TRUE(speak("hello world"));
+    TEST_ASSERT_EQUAL(1, sim->spoken.size());
+    TEST_ASSERT_EQUAL_STRING("hello world", sim->spoken[0].c_str());
+    TEST_ASSERT_EQUAL(1, sim->finished.load());
+}
+
+/// @brief a lost RDY edge outside the upload - deadline, fault, the next init() succeeds
+void test_dropped_rdy_recovers() {
+    // responses of init(): 0 version, 1..16 firmware blocks, 17 run, 18 test, 19 version,
+    // 20 audio, 21 volume, 22 tts
+    for (uint32_t at : { 0u, 17u, 18u, 22u }) {
+        sim->inject(ChipSim::Fault::dropRdy, at);
+        auto start = host::clock().micros();
+        TEST_ASSERT_FALSE(chip->init());
+        TEST_ASSERT_TRUE(chip->isFaulted());
+        TEST_ASSERT_TRUE(chip->init());
+        TEST_ASSERT_FALSE(chip->isFaulted());
+        if (at == 0) report("dropped RDY of the version", start);
+    }
+    TEST_ASSERT_TRUE(speak("still alive"));
+}
+
+/// @brief a lost RDY edge in the upload - the chip is reset and the upload starts again
+void test_dropped_rdy_in_upload() {
+    for (uint32_t at : { 1u, 5u, 16u }) {
+        auto restarts = metrics().uploadRestarts.value();
+        auto resets = sim->resets.load();
+        sim->inject(ChipSim::Fault::dropRdy, at);
+        auto start = host::clock().micros();
+        TEST_ASSERT_TRUE(chip->init());
+        TEST_ASSERT_EQUAL(1, metrics().uploadRestarts.value() - restarts);
+        TEST_ASSERT_EQUAL(2, sim->resets.load() - resets);
+        TEST_ASSERT_TRUE(sim->isRunning());
+        if (at == 5) report("dropped RDY in the upload", start);
+    }
+}
+
+/// @brief noise before the start byte is skipped, more than the sync limit is a fault
+void test_garbage_bytes() {
+    sim->inject(ChipSim::Fault::garbage, 0, 1000, 100);
+    TEST_ASSERT_TRUE(chip->init());
+    TEST_ASSERT_TRUE(speak("through the noise"));
+
+    TEST_ASSERT_TRUE(chip->init());
+    sim->inject(ChipSim::Fault::garbage, 18, 1, 300);
+    TEST_ASSERT_FALSE(chip->init());
+    TEST_ASSERT_TRUE(chip->isFaulted());
+    TEST_ASSERT_TRUE(chip->init());
+
+    // lost sync in the upload restarts it
+    auto restarts = metrics().uploadRestarts.value();
+    sim->inject(ChipSim::Fault::garbage, 3, 1, 300);
+    TEST_ASSERT_TRUE(chip->init());
+    TEST_ASSERT_EQUAL(1, metrics().uploadRestarts.value() - restarts);
+}
+
+/// @brief a rejected firmware block is sent again, the image stays consistent
+void test_rejected_block_retried() {
+    auto retries = metrics().uploadBlockRetries.value();
+    sim->inject(ChipSim::Fault::reject, 4, 2);
+    TEST_ASSERT_TRUE(chip->init());
+    TEST_ASSERT_TRUE(sim->isRunning());
+    TEST_ASSERT_EQUAL(2, metrics().uploadBlockRetries.value() - retries);
+    TEST_ASSERT_EQUAL(1, sim->resets.load());
+}
+
+/// @brief a block rejected by every retry ends init(), the answering chip is not reset again
+void test_rejected_block_fatal() {
+    auto restarts = metrics().uploadRestarts.value();
+    sim->inject(ChipSim::Fault::reject, 4, 4);
+    TEST_ASSERT_FALSE(chip->init());
+    TEST_ASSERT_FALSE(sim->isRunning());
+    TEST_ASSERT_EQUAL(0, metrics().uploadRestarts.value() - restarts);
+    TEST_ASSERT_EQUAL(1, sim->resets.load());
+    TEST_ASSERT_EQUAL(3, sim->blocks.load());
+}
+
+/// @brief ISC_ERROR_IND or a lost RDY while speaking - recovered and the utterance replayed
+void test_speech_replayed() {
+    TEST_ASSERT_TRUE(chip->init());
+    auto start = host::clock().micros();
+    sim->inject(ChipSim::Fault::errorInd);
+    TEST_ASSERT_EQUAL(2, speakRecovered("replayed after an error"));
+    report("ISC_ERROR_IND on speak", start);
+
+    // the end of the utterance is lost
+    sim->inject(ChipSim::Fault::dropRdy, 1);
+    TEST_ASSERT_TRUE(speakRecovered("replayed after a lost end") >= 2);
+
+    TEST_ASSERT_EQUAL_STRING("replayed after an error", sim->spoken.front().c_str());
+    TEST_ASSERT_EQUAL_STRING("replayed after a lost end", sim->spoken.back().c_str());
+    TEST_ASSERT_TRUE(chip->isReady());
+}
+
+/// @brief every wait is bounded, a chip that never answers fails init() in bounded time
+void test_dead_chip_bounded() {
+    sim->inject(ChipSim::Fault::dropRdy, 0, 1000);
+    auto start = host::clock().micros();
+    TEST_ASSERT_FALSE(chip->init());
+    auto ms = (host::clock().micros() - start) / 1000;
+    TEST_ASSERT_TRUE(ms < 2000);
+    TEST_ASSERT_TRUE(chip->isFaulted());
+    TEST_ASSERT_FALSE(chip->speak("x", 1));
+}
+
+int main() {
+    host::clock().speedup(speedup);
+    UNITY_BEGIN();
+    RUN_TEST(test_init_and_speak);
+    RUN_TEST(test_dropped_rdy_recovers);
+    RUN_TEST(test_dropped_rdy_in_upload);
+    RUN_TEST(test_garbage_bytes);
+    RUN_TEST(test_rejected_block_retried);
+    RUN_TEST(test_rejected_block_fatal);
+    RUN_TEST(test_speech_replayed);
+    RUN_TEST(test_dead_chip_bounded);
+    return UNITY_END();
+}
@@ -0,0 +1,109 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief ISC messages built by the compiler against the hand written arrays of the original driver
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "isc_msg.h"
+
+// the original message definitions of S1V30120.h, byte for byte
+static const uint8_t testReq[12] = {0x0C, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+static const uint8_t verReq[4] = {0x04, 0x00, 0x05, 0x00};
+static const uint8_t runReq[4] = {0x04, 0x00, 0x02, 0x10};
+static const uint8_t ttsReqEpson[12] = {0x0C, 0x00, ISC_TTS_CONFIG_REQ & 0xFF, (ISC_TTS_CONFIG_REQ & 0xFF00) >> 8,
+                             TTS_CONFIG_SAMPLE_RATE, TTS_CONFIG_VOICE, TTS_CONFIG_EPSON_PARSE, TTS_CONFIG_LANGUAGE,
+                             TTS_CONFIG_SPEAK_RATE_LSB, TTS_CONFIG_SPEAK_RATE_MSB, TTS_CONFIG_DATASOURCE, 0x00};
+static const uint8_t ttsReqDec[12] = {0x0C, 0x00, ISC_TTS_CONFIG_REQ & 0xFF, (ISC_TTS_CONFIG_REQ & 0xFF00) >> 8,
+                             TTS_CONFIG_SAMPLE_RATE, TTS_CONFIG_VOICE, TTS_CONFIG_DEC_PARSE, TTS_CONFIG_LANGUAGE,
+                             TTS_CONFIG_SPEAK_RATE_LSB, TTS_CONFIG_SPEAK_RATE_MSB, TTS_CONFIG_DATASOURCE, 0x00};
+static const uint8_t volumeMaxReq[6] = {0x06, 0x00, 0x0A, 0x00, 0x00, 0x00};
+// 13 bytes, sent with the length 0x0C
+static const uint8_t audioReq[13] = {0x0C, 0x00, ISC_AUDIO_CONFIG_REQ & 0xFF, (ISC_AUDIO_CONFIG_REQ & 0xFF00) >> 8,
+                               AUDIO_CONFIG_STEREO, AUDIO_CONFIG_GAIN, AUDIO_CONFIG_AMP, AUDIO_CONFIG_ASR, AUDIO_CONFIG_AR,
+                               AUDIO_CONFIG_ATC, AUDIO_CONFIG_ACS, AUDIO_CONFIG_DCA, 0x00};
+
+// the same arguments as the message definitions of S1V30120Driver
+static constexpr auto cTest = Isc::test();
+static constexpr auto cVer = Isc::version();
+static constexpr auto cRun = Isc::run();
+static constexpr auto cStop = Isc::stop();
+static constexpr auto cTtsEpson = Isc::ttsConfig<TTS_CONFIG_SAMPLE_RATE, TTS_CONFIG_VOICE, TTS_CONFIG_EPSON_PARSE, TTS_CONFIG_LANGUAGE,
+                                                 TTS_CONFIG_SPEAK_RATE_LSB | (TTS_CONFIG_SPEAK_RATE_MSB << 8), TTS_CONFIG_DATASOURCE>();
+static constexpr auto cTtsDec = Isc::ttsConfig<TTS_CONFIG_SAMPLE_RATE, TTS_CONFIG_VOICE, TTS_CONFIG_DEC_PARSE, TTS_CONFIG_LANGUAGE,
+                                               TTS_CONFIG_SPEAK_RATE_LSB | (TTS_CONFIG_SPEAK_RATE_MSB << 8), TTS_CONFIG_DATASOURCE>();
+static constexpr auto cVolumeMax = Isc::volume<0>();
+static constexpr auto cAudio = Isc::audioConfig<AUDIO_CONFIG_STEREO, AUDIO_CONFIG_GAIN, AUDIO_CONFIG_AMP, AUDIO_CONFIG_ASR,
+                                                AUDIO_CONFIG_AR, AUDIO_CONFIG_ATC, AUDIO_CONFIG_ACS, AUDIO_CONFIG_DCA>();
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+/// @brief the whole frame equals the original array, the length field counts what is sent
+template <size_t N>
+static void same(const IscFrame<N>& frame, const uint8_t* original, size_t sent) {
+    TEST_ASSERT_EQUAL(sent, N);
+    TEST_ASSERT_EQUAL(N, frame.length());
+    TEST_ASSERT_EQUAL(original[0] | (original[1] << 8), frame.length());
+    TEST_ASSERT_EQUAL(0, memcmp(frame.bytes, original, N));
+}
+
+void test_constant_frames() {
+    same(cTest, testReq, sizeof(testReq));
+    same(cVer, verReq, sizeof(verReq));
+    same(cRun, runReq, sizeof(runReq));
+    same(cTtsEpson, ttsReqEpson, sizeof(ttsReqEpson));
+    same(cTtsDec, ttsReqDec, sizeof(ttsReqDec));
+    same(cVolumeMax, volumeMaxReq, sizeof(volumeMaxReq));
+    same(cAudio, audioReq, 0x0C);
+    TEST_ASSERT_EQUAL(ISC_TTS_STOP_REQ, cStop.id());
+    TEST_ASSERT_EQUAL(4, cStop.length());
+}
+
+/// @brief run-time headers of speak & volume as the original driver wrote them
+void test_headers() {
+    uint8_t buff[Isc::headerSize];
+    const char* text = "hello";
+    size_t sz = strlen(text);
+    // speak - flush byte, text, zero
+    TEST_ASSERT_EQUAL(sz + 6, Isc::header(buff, ISC_TTS_SPEAK_REQ, sz + 2));
+    const uint8_t speak[] = { static_cast<uint8_t>(sz + 6), 0x00, ISC_TTS_SPEAK_REQ & 0xFF, ISC_TTS_SPEAK_REQ >> 8 };
+    TEST_ASSERT_EQUAL(0, memcmp(buff, speak, sizeof(speak)));
+
+    TEST_ASSERT_EQUAL(sizeof(volumeMaxReq), Isc::header(buff, ISC_AUDIO_VOLUME_REQ, 2));
+    TEST_ASSERT_EQUAL(0, memcmp(buff, volumeMaxReq, Isc::headerSize));
+
+    // firmware block, the length over 255
+    TEST_ASSERT_EQUAL(2048, Isc::header(buff, ISC_BOOT_LOAD_REQ, 2044));
+    TEST_ASSERT_EQUAL(0x00, buff[0]);
+    TEST_ASSERT_EQUAL(0x08, buff[1]);
+    TEST_ASSERT_EQUAL(ISC_BOOT_LOAD_REQ & 0xFF, buff[2]);
+    TEST_ASSERT_EQUAL(ISC_BOOT_LOAD_REQ >> 8, buff[3]);
+}
+
+/// @brief the gain of ISC_AUDIO_VOLUME_REQ is a little endian int16 [dB]
+void test_volume_range() {
+    constexpr auto low = Isc::volume<-48>();
+    constexpr auto high = Isc::volume<18>();
+    TEST_ASSERT_EQUAL(0xD0, low.bytes[4]);
+    TEST_ASSERT_EQUAL(0xFF, low.bytes[5]);
+    TEST_ASSERT_EQUAL(18, high.bytes[4]);
+    TEST_ASSERT_EQUAL(0x00, high.bytes[5]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_constant_frames);
+    RUN_TEST(test_headers);
+    RUN_TEST(test_volume_range);
+    return UNITY_END();
+}
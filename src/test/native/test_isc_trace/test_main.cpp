@@ -0,0 +1,89 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief IscTrace - ring wrap, windowed dump & cost of one record
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <unity.h>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include "isc_trace.h"
+
+using Trace = IscTrace<128>;
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static std::vector<uint8_t> dump() {
+    std::vector<uint8_t> out(Trace::size());
+    TEST_ASSERT_EQUAL(out.size(), Trace::dump(out.data(), 0, out.size()));
+    return out;
+}
+
+static uint16_t get16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+void test_ring_wraps() {
+    for (uint32_t i = 0; i < 300; i++) Trace::record(TraceKind::send, i, 1, 2, 3, 4);
+    auto out = dump();
+    TEST_ASSERT_EQUAL(Trace::headerSize + 128 * Trace::eventSize, out.size());
+    TEST_ASSERT_EQUAL_MEMORY("ISCT", out.data(), 4);
+    TEST_ASSERT_EQUAL(128, get16(&out[6]));
+
+    // oldest first
+    auto first = &out[Trace::headerSize];
+    auto last = &out[out.size() - Trace::eventSize];
+    TEST_ASSERT_EQUAL(300 - 128, get16(first + 12));
+    TEST_ASSERT_EQUAL(299, get16(last + 12));
+    TEST_ASSERT_EQUAL((300 - 128) & 0xFF, first[19]);
+}
+
+void test_windowed_dump() {
+    auto whole = dump();
+    std::vector<uint8_t> pieces;
+    uint8_t buff[37];
+    size_t len;
+    while ((len = Trace::dump(buff, pieces.size(), sizeof(buff))) > 0) pieces.insert(pieces.end(), buff, buff + len);
+    TEST_ASSERT_TRUE(pieces == whole);
+}
+
+/// @brief the trace is on the SPI path, one record must stay far below a byte time (10 us at 750 kHz)
+void test_record_cost() {
+    const uint32_t n = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < n; i++) Trace::record(TraceKind::response, i, 6, 0, i, i);
+    double traced = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < n; i++) NoTrace::record(TraceKind::response, i, 6, 0, i, i);
+    double none = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+
+    // writers on two threads, the ring stays consistent
+    std::thread other([] { for (uint32_t i = 0; i < 100000; i++) Trace::record(TraceKind::send, 1, 1, 1, 1, 1); });
+    for (uint32_t i = 0; i < 100000; i++) Trace::record(TraceKind::send, 2, 2, 2, 2, 2);
+    other.join();
+    TEST_ASSERT_EQUAL(Trace::headerSize + 128 * Trace::eventSize, dump().size());
+
+    char msg[80];
+    snprintf(msg, sizeof(msg), "record: IscTrace %.1f ns, NoTrace %.1f ns", traced, none);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_LESS_THAN(1000.0, traced);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_wraps);
+    RUN_TEST(test_windowed_dump);
+    RUN_TEST(test_record_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,117 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Tick jitter before & after the task split - the polled loop() against the pinned tasks
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <esp_timer.h>
+#include "metrics.h"
+
+// model of one utterance as the driver runs it: 200 ms CS setup of sendMsg, then polling isFinished()
+static const uint32_t setupMs = 200;
+static const uint32_t speechMs = 800;
+static const uint32_t utterances = 4;
+static const uint32_t periodMs = 20;        // housePeriod of main.cpp
+
+void setUp() {
+    host::clock().speedup(2);
+}
+
+void tearDown() {
+    host::clock().speedup(1);
+}
+
+/// @brief one utterance, blocks the calling task like S1V30120::speak() & the isFinished() loop
+static void speak() {
+    delay(setupMs);
+    auto start = millis();
+    while (millis() - start < speechMs) delay(10);
+}
+
+static uint32_t polledAverage = 0;     // [us]
+
+/// @brief the worst & the average deviation as the text of the test log
+/// @return average deviation [us]
+static uint32_t report(const char* label, const Histogram& h, uint32_t ticks, uint32_t worst) {
+    char txt[96];
+    snprintf(txt, sizeof(txt), "%s: %u ticks, average %u us, worst %u us, > 20 ms %u",
+             label, (unsigned) ticks, (unsigned) (h.sum() / (ticks ? ticks : 1)), (unsigned) worst,
+             (unsigned) (h.count(Histogram::buckets - 3) + h.count(Histogram::buckets - 2) +
+                         h.count(Histogram::buckets - 1) + h.count(Histogram::buckets)));
+    TEST_MESSAGE(txt);
+    return static_cast<uint32_t>(h.sum() / (ticks ? ticks : 1));
+}
+
+/// @brief deviation of one tick from the period
+static uint32_t late(int64_t& last) {
+    int64_t now = esp_timer_get_time();
+    int64_t d = now - last - periodMs * 1000LL;
+    last = now;
+    return static_cast<uint32_t>(d < 0 ? -d : d);
+}
+
+/// @brief before - loop() runs the periodic work and the speech in turn
+void test_polled_loop() {
+    Histogram h;
+    uint32_t worst = 0;
+    uint32_t ticks = 0;
+    uint32_t spoken = 0;
+    int64_t last = esp_timer_get_time();
+    while (spoken < utterances) {
+        delay(periodMs);
+        auto d = late(last);
+        h.observe(d);
+        if (d > worst) worst = d;
+        ticks++;
+        // httpUpdate() - the queued text is spoken right away
+        if (ticks % 10 == 0) {
+            speak();
+            spoken++;
+        }
+    }
+    polledAverage = report("polled loop", h, ticks, worst);
+    // every utterance delays the tick by the whole speech
+    TEST_ASSERT_TRUE(worst >= (setupMs + speechMs) * 1000);
+}
+
+/// @brief after - the speech runs on its own task, the periodic task waits with vTaskDelayUntil
+void test_pinned_tasks() {
+    std::atomic<bool> done {false};
+    std::thread synth([&done] () {
+        for (uint32_t i = 0; i < utterances; i++) speak();
+        done = true;
+    });
+
+    Histogram h;
+    uint32_t worst = 0;
+    uint32_t ticks = 0;
+    TickType_t wake = xTaskGetTickCount();
+    int64_t last = esp_timer_get_time();
+    while (!done) {
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(periodMs));
+        auto d = late(last);
+        h.observe(d);
+        if (d > worst) worst = d;
+        ticks++;
+    }
+    synth.join();
+    // the host scheduler adds its own noise, the speech itself must not show up
+    TEST_ASSERT_TRUE(report("pinned tasks", h, ticks, worst) < polledAverage / 10);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_polled_loop);
+    RUN_TEST(test_pinned_tasks);
+    return UNITY_END();
+}
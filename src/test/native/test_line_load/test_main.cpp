@@ -0,0 +1,120 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief LineServer - load of several scripted clients, answers under a full TCP buffer
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <unity.h>
+#include <string>
+#include <thread>
+#include <chrono>
+#include "line_server.h"
+
+static const uint16_t port = 7000;
+static TalkQueue* queue = nullptr;
+static LineServer* server = nullptr;
+
+void setUp() {
+    queue = new TalkQueue();
+    server = new LineServer(queue);
+    server->init(port);
+}
+
+void tearDown() {
+    delete server;
+    delete queue;
+}
+
+/// @brief answers "OK" / "ERROR" in the sent text
+static size_t count(const std::string& sent, const char* what) {
+    size_t n = 0;
+    for (size_t p = sent.find(what); p != std::string::npos; p = sent.find(what, p + 1)) n++;
+    return n;
+}
+
+/// @brief clients send lines in odd chunks while a synthesizer drains the queue,
+/// every line is queued and answered
+void test_load() {
+    const uint8_t clients = LineServer::maxClients;
+    const size_t lines = 20000;
+    AsyncClient* c[clients];
+    for (auto& cl : c) cl = AsyncServer::at(port)->connect();
+
+    std::atomic<bool> run {true};
+    std::atomic<size_t> spoken {0};
+    std::thread synth([&] () {
+        Utterance u;
+        while (run || queue->size()) {
+            if (queue->pop(u)) spoken++;
+            else std::this_thread::yield();
+        }
+    });
+
+    std::string text;
+    for (size_t i = 0; i < lines; i++) text += "line number " + std::to_string(i) + " of the load test\n";
+
+    auto start = std::chrono::steady_clock::now();
+    size_t errors = 0;
+    for (size_t pos = 0, chunk = 1; pos < text.size(); pos += chunk, chunk = chunk % 97 + 13) {
+        for (auto cl : c) {
+            cl->receive(text.data() + pos, pos + chunk < text.size() ? chunk : text.size() - pos);
+            cl->ack(cl->sent.size());
+        }
+        // a full queue is answered by ERROR, the clients wait for the synthesizer
+        while (queue->size() > 0) std::this_thread::yield();
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    run = false;
+    synth.join();
+
+    for (auto cl : c) {
+        TEST_ASSERT_EQUAL(lines, count(cl->sent, "OK ") + count(cl->sent, "ERROR "));
+        errors += count(cl->sent, "ERROR ");
+        cl->disconnect();
+    }
+    TEST_ASSERT_EQUAL(0, errors);
+    TEST_ASSERT_EQUAL(clients * lines, spoken.load());
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%u clients, %.0f lines/s", clients, clients * lines / sec);
+    TEST_MESSAGE(msg);
+}
+
+/// @brief the client does not read, answers wait and go out as the client acknowledges
+void test_answers_wait_for_ack() {
+    auto c = AsyncServer::at(port)->connect(16);
+    c->receive("one\ntwo\nthree\n", 14);
+    TEST_ASSERT_EQUAL(16, c->sent.size());
+    TEST_ASSERT_FALSE(c->closed());
+
+    c->ack(16);
+    c->ack(16);
+    TEST_ASSERT_EQUAL(3, count(c->sent, "OK "));
+    TEST_ASSERT_EQUAL('\n', c->sent.back());
+    c->disconnect();
+}
+
+/// @brief a client that never reads is disconnected, no answer is skipped
+void test_no_reader_closed() {
+    auto c = AsyncServer::at(port)->connect(16);
+    for (int i = 0; i < 100 && !c->closed(); i++) {
+        c->receive("x\n", 2);
+        Utterance u;
+        queue->pop(u);
+    }
+    TEST_ASSERT_TRUE(c->closed());
+    c->disconnect();
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_load);
+    RUN_TEST(test_answers_wait_for_ack);
+    RUN_TEST(test_no_reader_closed);
+    return UNITY_END();
+}
@@ -0,0 +1,51 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Metrics - histogram sum beyond 32 bits, windowed rendering
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <unity.h>
+#include <string>
+#include "metrics.h"
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static std::string render(const Metrics::Snapshot& s) {
+    MetricsWriter counter(nullptr, 0, 0);
+    Metrics::render(s, counter);
+    std::string out(counter.length(), 0);
+    // piece by piece like the chunked response
+    for (size_t from = 0; from < out.size(); from += 100) {
+        MetricsWriter w(&out[from], from, 100);
+        Metrics::render(s, w);
+    }
+    return out;
+}
+
+void test_sum_beyond_32_bits() {
+    Metrics m;
+    for (int i = 0; i < 3; i++) m.speakLatency.observe(2000000000);    // 3 x 2000 s
+    TEST_ASSERT_EQUAL_UINT64(6000000000ULL, m.speakLatency.sum());
+
+    Metrics::Snapshot s {};
+    m.snapshot(s);
+    auto txt = render(s);
+    TEST_ASSERT_TRUE(txt.find("dectalk_speak_seconds_sum 6000.000000\n") != std::string::npos);
+    TEST_ASSERT_TRUE(txt.find("dectalk_speak_seconds_bucket{le=\"+Inf\"} 3\n") != std::string::npos);
+    TEST_ASSERT_TRUE(txt.find("dectalk_speak_seconds_count 3\n") != std::string::npos);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_sum_beyond_32_bits);
+    return UNITY_END();
+}
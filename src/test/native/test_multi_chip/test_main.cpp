@@ -0,0 +1,115 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Several simulated S1V30120 on one SPI bus - throughput scales with the number of chips
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <unity.h>
+#include <thread>
+#include "chip_sim.h"
+#include "S1V30120.h"
+
+using host::ChipSim;
+
+struct ChipPins {
+    uint8_t cs;
+    uint8_t rst;
+    uint8_t rdy;
+    uint8_t mute;
+};
+
+static const ChipPins pins[] = {
+    { 5, 13, 34, 12 },
+    { 15, 14, 35, 27 },
+    { 16, 25, 36, 32 },
+    { 17, 26, 39, 33 },
+};
+static const uint8_t maxChips = sizeof(pins) / sizeof(pins[0]);
+static const uint32_t speedup = 10;
+static const uint32_t utterances = 6;       // per chip
+static const char* text = "twenty characters...";
+
+static SPIClass spi;
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+/// @brief one synthesizer task: speak and wait for the end like synthTask
+static void speakAll(S1V30120* chip, std::atomic<uint32_t>* spoken) {
+    for (uint32_t i = 0; i < utterances; i++) {
+        if (!chip->speak(text, strlen(text), false, false)) return;
+        while (!chip->isFinished()) {
+            if (chip->isFaulted()) return;
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+        (*spoken)++;
+    }
+}
+
+/**
+ * @brief utterances per second of the simulated clock with n chips speaking at once
+ *
+ * @param n - chips on the bus
+ * @return float - throughput, 0 - failure
+ */
+static float throughput(uint8_t n) {
+    ChipSim* sims[maxChips] {};
+    S1V30120* chips[maxChips] {};
+    std::thread tasks[maxChips];
+    std::atomic<uint32_t> spoken {0};
+    bool ok = true;
+
+    for (uint8_t i = 0; i < n; i++) {
+        sims[i] = new ChipSim(pins[i].cs, pins[i].rst, pins[i].rdy);
+        chips[i] = new S1V30120(&spi, pins[i].rst, pins[i].rdy, pins[i].mute, pins[i].cs);
+    }
+    // the uploads share the bus too
+    for (uint8_t i = 0; i < n; i++) {
+        tasks[i] = std::thread([&ok, chip = chips[i]] () { if (!chip->init()) ok = false; });
+    }
+    for (uint8_t i = 0; i < n; i++) tasks[i].join();
+
+    auto start = host::clock().micros();
+    for (uint8_t i = 0; i < n; i++) tasks[i] = std::thread(speakAll, chips[i], &spoken);
+    for (uint8_t i = 0; i < n; i++) tasks[i].join();
+    auto us = host::clock().micros() - start;
+
+    for (uint8_t i = 0; i < n; i++) {
+        if (sims[i]->finished != utterances) ok = false;
+        delete chips[i];
+        delete sims[i];
+    }
+    if (!ok || spoken != n * utterances) return 0;
+
+    float rc = spoken * 1e6f / us;
+    char txt[96];
+    snprintf(txt, sizeof(txt), "%u chips: %.2f utterances/s", (unsigned) n, rc);
+    TEST_MESSAGE(txt);
+    return rc;
+}
+
+/// @brief the CS setup pauses of one chip do not hold the bus, the chips speak in parallel
+void test_throughput_scales() {
+    auto one = throughput(1);
+    auto two = throughput(2);
+    auto four = throughput(4);
+    TEST_ASSERT_TRUE(one > 0);
+    TEST_ASSERT_TRUE(two > 1.7f * one);
+    TEST_ASSERT_TRUE(four > 3.0f * one);
+    TEST_ASSERT_EQUAL(0, host::spiBus().collisions());
+}
+
+int main() {
+    host::clock().speedup(speedup);
+    UNITY_BEGIN();
+    RUN_TEST(test_throughput_scales);
+    return UNITY_END();
+}
@@ -0,0 +1,82 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief S1V30120 driver with the host pin policy - pin accesses of one ISC message
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <unity.h>
+#include "chip_sim.h"
+#include "host_pins.h"
+#include "S1V30120.h"
+
+using Driver = S1V30120Driver<NoTrace, HostPins>;
+
+static const uint8_t csPin = 5;
+static const uint8_t rstPin = 13;
+static const uint8_t rdyPin = 34;
+static const uint8_t mutePin = 12;
+
+static SPIClass spi;
+static host::ChipSim* sim = nullptr;
+static Driver* chip = nullptr;
+
+void setUp() {
+    sim = new host::ChipSim(csPin, rstPin, rdyPin);
+    chip = new Driver(&spi, rstPin, rdyPin, mutePin, csPin);
+}
+
+void tearDown() {
+    delete chip;
+    delete sim;
+}
+
+/// @brief pin accesses as the text of the test log
+static void report(const char* what, uint32_t messages) {
+    char txt[128];
+    snprintf(txt, sizeof(txt), "%s: %u messages, CS %u, RESET %u, MUTE %u writes, RDY %u reads",
+             what, (unsigned) messages, (unsigned) HostPins::writes()[csPin], (unsigned) HostPins::writes()[rstPin],
+             (unsigned) HostPins::writes()[mutePin], (unsigned) HostPins::reads()[rdyPin]);
+    TEST_MESSAGE(txt);
+}
+
+/// @brief one selection per request & per response, each one a CS low & high, one transaction
+void test_one_selection_per_message() {
+    TEST_ASSERT_TRUE(chip->init());
+
+    HostPins::clear();
+    TEST_ASSERT_TRUE(chip->speak("pins", 4, false, true));
+    TEST_ASSERT_EQUAL(4, HostPins::writes()[csPin].load());
+    TEST_ASSERT_EQUAL(1, HostPins::writes()[mutePin].load());
+    TEST_ASSERT_EQUAL(0, HostPins::writes()[rstPin].load());
+    report("speak", 2);
+
+    while (!chip->isFinished()) vTaskDelay(pdMS_TO_TICKS(10));
+    TEST_ASSERT_EQUAL(6, HostPins::writes()[csPin].load());
+    TEST_ASSERT_TRUE(host::gpio().read(csPin));     // released
+    TEST_ASSERT_EQUAL(0, host::spiBus().collisions());
+}
+
+/// @brief the whole init() - the firmware blocks go out under one CS assertion each
+void test_init_pin_accesses() {
+    HostPins::clear();
+    TEST_ASSERT_TRUE(chip->init());
+    uint32_t blocks = sim->blocks;
+    // version, blocks, run, test, version, audio, volume, tts - request & response each
+    uint32_t messages = 2 * (blocks + 7);
+    TEST_ASSERT_EQUAL(2 * messages + 1, HostPins::writes()[csPin].load());
+    TEST_ASSERT_EQUAL(2, HostPins::writes()[rstPin].load());
+    report("init", messages);
+}
+
+int main() {
+    host::clock().speedup(20);
+    UNITY_BEGIN();
+    RUN_TEST(test_one_selection_per_message);
+    RUN_TEST(test_init_pin_accesses);
+    return UNITY_END();
+}
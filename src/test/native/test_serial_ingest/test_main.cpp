@@ -0,0 +1,293 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief SerialIngest over a pty - 1 MB of text with XON/XOFF, nothing is lost,
+ * stray 0xC0 in the text & throughput of the binary protocol
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <unity.h>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <stdlib.h>
+#include <termios.h>
+#include "serial_ingest.h"
+
+static TalkQueue queue;
+static SynthPool synth;
+static SerialIngest console(&Serial, &queue);
+static SerialFrame* frames = nullptr;
+static int master = -1;
+
+// the peer of the terminal, reads the echo & the flow control, in the binary mode the acks
+static std::atomic<bool> held {false};
+static std::atomic<bool> reading {true};
+static std::atomic<bool> binaryPeer {false};
+static std::atomic<uint32_t> acked {0};
+static std::atomic<uint32_t> refused {0};
+static std::thread peer;
+
+// the synthesizer, collects the spoken text
+static std::mutex spokenMtx;
+static std::string spoken;
+static std::atomic<size_t> utterances {0};
+static std::thread speaker;
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static void serialTask(void*) {
+    console.run();
+}
+
+/// @brief pty in raw mode, the slave is the UART
+static void open() {
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    TEST_ASSERT_TRUE(master >= 0);
+    TEST_ASSERT_EQUAL(0, grantpt(master));
+    TEST_ASSERT_EQUAL(0, unlockpt(master));
+    int slave = ::open(ptsname(master), O_RDWR | O_NOCTTY);
+    TEST_ASSERT_TRUE(slave >= 0);
+    termios t;
+    for (int fd : { master, slave }) {
+        tcgetattr(fd, &t);
+        cfmakeraw(&t);
+        tcsetattr(fd, TCSANOW, &t);
+    }
+    Serial.attach(slave);
+
+    peer = std::thread([] () {
+        uint8_t buff[256];
+        SlipDecoder<32> decoder;
+        while (reading) {
+            pollfd p { master, POLLIN, 0 };
+            if (poll(&p, 1, 10) <= 0) continue;
+            auto n = ::read(master, buff, sizeof(buff));
+            for (ssize_t i = 0; i < n; i++) {
+                if (binaryPeer) {
+                    if (!decoder.feed(buff[i])) continue;
+                    auto f = decoder.data();
+                    if (decoder.size() >= 3 && f[0] == (SerialFrame::ack | static_cast<uint8_t>(SerialFrame::Cmd::speak))) {
+                        if (f[2] == static_cast<uint8_t>(SerialFrame::Result::ok)) acked++;
+                        else refused++;
+                    }
+                    decoder.reset();
+                } else if (buff[i] == SerialIngest::xoff) {
+                    held = true;
+                } else if (buff[i] == SerialIngest::xon) {
+                    held = false;
+                }
+            }
+        }
+    });
+
+    speaker = std::thread([] () {
+        Utterance u;
+        while (true) {
+            if (!queue.pop(u)) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                continue;
+            }
+            queue.notify(TalkEvent::started, u.id);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            {
+                std::lock_guard<std::mutex> lck(spokenMtx);
+                spoken.append(u.text, u.len);
+                spoken += ' ';
+            }
+            utterances++;
+            queue.notify(TalkEvent::finished, u.id);
+        }
+    });
+
+    TEST_ASSERT_TRUE(console.init(115200, SerialIngest::FlowControl::xonxoff));
+    frames = new SerialFrame(&queue, &synth);
+    TEST_ASSERT_TRUE(console.setFrames(frames));
+    xTaskCreatePinnedToCore(serialTask, "serial", 4096, nullptr, 2, nullptr, 0);
+}
+
+/// @brief text without the white space, a word longer than one utterance is split without a space
+static std::string letters(const std::string& text) {
+    std::string out;
+    for (char ch : text) {
+        if (ch != '\r' && ch != '\n' && ch != ' ') out += ch;
+    }
+    return out;
+}
+
+/// @brief lines of 1 to 1000 characters, every tenth one without any space
+static std::string document(size_t size) {
+    std::mt19937 rnd(1234);
+    std::string text;
+    size_t line = 0;
+    while (text.size() < size) {
+        size_t len = 1 + rnd() % 1000;
+        bool solid = ++line % 10 == 0;
+        size_t start = text.size();
+        while (text.size() - start < len) {
+            if (text.size() > start && !solid && rnd() % 6 == 0 && text.back() != ' ') text += ' ';
+            else text += static_cast<char>('a' + rnd() % 26);
+        }
+        if (text.back() == ' ') text.pop_back();
+        text += line % 3 ? "\n" : "\r\n";
+    }
+    return text;
+}
+
+/// @brief the sender honors XON/XOFF, the text is written in chunks of a UART FIFO
+static double send(const std::string& text) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t pos = 0; pos < text.size(); ) {
+        if (held) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            continue;
+        }
+        size_t n = text.size() - pos < 64 ? text.size() - pos : 64;
+        auto w = ::write(master, text.data() + pos, n);
+        if (w > 0) pos += w;
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// @brief 1 MB with long lines, every character is spoken in the order of the text
+void test_megabyte_without_loss() {
+    auto text = document(1 << 20);
+    auto expected = letters(text);
+    auto sec = send(text);
+
+    // the rest in the UART & the queue
+    auto start = std::chrono::steady_clock::now();
+    std::string got;
+    while (std::chrono::steady_clock::now() - start < std::chrono::seconds(60)) {
+        {
+            std::lock_guard<std::mutex> lck(spokenMtx);
+            got = letters(spoken);
+        }
+        if (got.size() >= expected.size()) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    char txt[96];
+    snprintf(txt, sizeof(txt), "%u bytes in %.2f s, %u utterances", (unsigned) text.size(), sec, (unsigned) utterances.load());
+    TEST_MESSAGE(txt);
+    TEST_ASSERT_EQUAL(expected.size(), got.size());
+    TEST_ASSERT_TRUE(expected == got);
+}
+
+/// @brief spoken text so far
+static std::string said() {
+    std::lock_guard<std::mutex> lck(spokenMtx);
+    return spoken;
+}
+
+/// @brief wait until the text is spoken
+static bool wait(const std::string& what, uint32_t ms = 2000) {
+    for (uint32_t t = 0; t < ms; t += 10) {
+        if (said().find(what) != std::string::npos) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+/// @brief 0xC0 typed at the start of a line (Latin-1 'A grave') is text, no binary mode
+void test_stray_end_is_text() {
+    const std::string line = "\xC0 la carte menu";
+    send(line + "\r\n");
+    TEST_ASSERT_TRUE(wait(line));
+    TEST_ASSERT_FALSE(frames->isActive());
+
+    // a frame with an invalid CRC is text too
+    const std::string bad = "\xC0\x01\x07\x00\x00\xC0 broken frame";
+    send(bad + "\n");
+    TEST_ASSERT_TRUE(wait(bad));
+    TEST_ASSERT_FALSE(frames->isActive());
+}
+
+/// @brief SLIP encoded request with CRC
+static std::string frame(SerialFrame::Cmd cmd, uint8_t seq, const std::string& payload) {
+    std::string raw;
+    raw += static_cast<char>(cmd);
+    raw += static_cast<char>(seq);
+    raw += payload;
+    auto crc = Crc16::calc(reinterpret_cast<const uint8_t*>(raw.data()), raw.size());
+    raw += static_cast<char>(crc & 0xFF);
+    raw += static_cast<char>(crc >> 8);
+
+    std::string out(1, static_cast<char>(SerialFrame::end));
+    for (char ch : raw) {
+        auto b = static_cast<uint8_t>(ch);
+        if (b == SerialFrame::end || b == SlipDecoder<1>::esc) {
+            out += static_cast<char>(SlipDecoder<1>::esc);
+            out += static_cast<char>(b == SerialFrame::end ? SlipDecoder<1>::escEnd : SlipDecoder<1>::escEsc);
+        } else {
+            out += ch;
+        }
+    }
+    out += static_cast<char>(SerialFrame::end);
+    return out;
+}
+
+/// @brief speak frames with a window of unacknowledged requests, a refused one is sent again.
+/// Reports the payload rate against the fastest UART (921600 Bd, 92 kB/s).
+void test_binary_throughput() {
+    const uint32_t count = 4000;
+    const uint32_t window = 8;
+    binaryPeer = true;
+    std::string text(200, 'x');
+    for (size_t i = 0; i < text.size(); i += 8) text[i] = ' ';
+
+    auto start = std::chrono::steady_clock::now();
+    uint32_t sent = 0;
+    while (acked < count) {
+        if (sent - acked - refused < window && sent - refused < count) {
+            auto f = frame(SerialFrame::Cmd::speak, static_cast<uint8_t>(sent), text);
+            ::write(master, f.data(), f.size());
+            sent++;
+        } else {
+            std::this_thread::yield();
+        }
+        if (std::chrono::steady_clock::now() - start > std::chrono::seconds(60)) break;
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    char txt[128];
+    snprintf(txt, sizeof(txt), "%u frames in %.2f s, %.0f frames/s, payload %.0f kB/s, %u refused (queue full)",
+             (unsigned) acked.load(), sec, acked / sec, acked * text.size() / sec / 1000, (unsigned) refused.load());
+    TEST_MESSAGE(txt);
+    TEST_ASSERT_EQUAL(count, acked.load());
+    TEST_ASSERT_TRUE(frames->isActive());
+    TEST_ASSERT_TRUE(acked * text.size() / sec > 92160);
+}
+
+/// @brief a silent binary client, the terminal is back in the text mode
+void test_binary_idle() {
+    TEST_ASSERT_TRUE(frames->isActive());
+    host::clock().advance((SerialFrame::binaryIdle + 1000) * 1000ULL);
+    for (int i = 0; i < 100 && frames->isActive(); i++) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    TEST_ASSERT_FALSE(frames->isActive());
+
+    binaryPeer = false;
+    send("typed again\n");
+    TEST_ASSERT_TRUE(wait("typed again"));
+}
+
+int main() {
+    UNITY_BEGIN();
+    open();
+    RUN_TEST(test_megabyte_without_loss);
+    RUN_TEST(test_stray_end_is_text);
+    RUN_TEST(test_binary_throughput);
+    RUN_TEST(test_binary_idle);
+    int rc = UNITY_END();
+    fflush(stdout);
+    _exit(rc);
+}
@@ -0,0 +1,101 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief Slab pool of the per-request state - classes, spill, exhaustion & the cost against malloc
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <unity.h>
+#include <chrono>
+#include <stdlib.h>
+#include "slab_pool.h"
+#include "talk_stream.h"
+
+/// @brief as TalkServer::Slabs, the scrape is about 750 bytes
+struct Layout {
+    static constexpr uint8_t classes = 2;
+    static constexpr uint16_t sizes[classes] = { slabSize(sizeof(TalkStream)), slabSize(752) };
+    static constexpr uint8_t counts[classes] = { 6, 2 };
+};
+
+using Pool = SlabPool<Layout>;
+
+static const uint32_t rounds = 1000000;
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_classes_and_spill() {
+    Pool pool;
+    Pool::Snapshot s;
+    void* streams[Layout::counts[0]];
+    for (auto& p : streams) {
+        p = pool.alloc(sizeof(TalkStream));
+        TEST_ASSERT_NOT_NULL(p);
+        TEST_ASSERT_EQUAL(0, reinterpret_cast<uintptr_t>(p) % 8);
+    }
+    // the own class is empty, the stream spills into the scrape class
+    auto spilled = pool.alloc(sizeof(TalkStream));
+    TEST_ASSERT_NOT_NULL(spilled);
+    auto scrape = pool.alloc(700);
+    TEST_ASSERT_NOT_NULL(scrape);
+    TEST_ASSERT_NULL(pool.alloc(700));
+    TEST_ASSERT_NULL(pool.alloc(Layout::sizes[1] + 1));
+
+    pool.snapshot(s);
+    TEST_ASSERT_EQUAL(Layout::counts[0], s.cls[0].used);
+    TEST_ASSERT_EQUAL(2, s.cls[1].used);
+    TEST_ASSERT_EQUAL(1, s.cls[1].exhausted);
+
+    int other = 0;
+    TEST_ASSERT_FALSE(pool.release(&other));
+    TEST_ASSERT_TRUE(pool.release(spilled));
+    TEST_ASSERT_TRUE(pool.release(scrape));
+    for (auto p : streams) TEST_ASSERT_TRUE(pool.release(p));
+    pool.snapshot(s);
+    TEST_ASSERT_EQUAL(0, s.cls[0].used + s.cls[1].used);
+    TEST_ASSERT_EQUAL(Layout::counts[0], s.cls[0].peak);
+}
+
+/// @brief ns per alloc & release of a request state, the pattern of a /talk POST
+template <class Alloc, class Free>
+static double measure(Alloc alloc, Free release) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < rounds; i++) {
+        auto a = alloc(sizeof(TalkStream));
+        auto b = alloc(700);
+        static_cast<volatile uint8_t*>(a)[0] = 1;
+        static_cast<volatile uint8_t*>(b)[0] = 1;
+        release(a);
+        release(b);
+    }
+    auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / rounds / 2;
+}
+
+void test_cost_against_malloc() {
+    Pool pool;
+    auto slab = measure([&pool] (size_t n) { return pool.alloc(n); }, [&pool] (void* p) { pool.release(p); });
+    auto heap = measure([] (size_t n) { return malloc(n); }, [] (void* p) { free(p); });
+
+    char txt[96];
+    snprintf(txt, sizeof(txt), "alloc & release: slab pool %.1f ns, malloc %.1f ns, arena %u bytes",
+             slab, heap, (unsigned) (Layout::sizes[0] * Layout::counts[0] + Layout::sizes[1] * Layout::counts[1]));
+    TEST_MESSAGE(txt);
+    // the mutex dominates, no search and no fragmentation - the same order as the heap
+    TEST_ASSERT_TRUE(slab < 10 * heap + 100);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_classes_and_spill);
+    RUN_TEST(test_cost_against_malloc);
+    return UNITY_END();
+}
@@ -0,0 +1,209 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief TalkQueue - order of the normal & urgent utterances
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <unity.h>
+#include <string>
+#include "talk_stream.h"
+
+static TalkQueue* queue = nullptr;
+
+void setUp() {
+    queue = new TalkQueue();
+}
+
+void tearDown() {
+    delete queue;
+}
+
+static std::string pop() {
+    Utterance u;
+    return queue->pop(u) ? std::string(u.text, u.len) : std::string();
+}
+
+void test_fifo() {
+    queue->push("a", 1);
+    queue->push("b", 1);
+    TEST_ASSERT_EQUAL_STRING("a", pop().c_str());
+    TEST_ASSERT_EQUAL_STRING("b", pop().c_str());
+    TEST_ASSERT_EQUAL(0, queue->size());
+}
+
+void test_urgent_in_arrival_order() {
+    queue->push("n1", 2);
+    queue->push("u1", 2, nullptr, true);
+    queue->push("n2", 2);
+    queue->push("u2", 2, nullptr, true);
+    queue->push("u3", 2, nullptr, true);
+    const char* expected[] = { "u1", "u2", "u3", "n1", "n2" };
+    for (auto e : expected) TEST_ASSERT_EQUAL_STRING(e, pop().c_str());
+}
+
+void test_urgent_wrapped_ring() {
+    // the head in the middle of the ring
+    for (int i = 0; i < 10; i++) queue->push("x", 1);
+    for (int i = 0; i < 10; i++) pop();
+    for (int i = 0; i < TalkQueue::capacity - 2; i++) queue->push("n", 1);
+    queue->push("u1", 2, nullptr, true);
+    queue->push("u2", 2, nullptr, true);
+    TEST_ASSERT_FALSE(queue->push("u3", 2, nullptr, true));
+    TEST_ASSERT_EQUAL_STRING("u1", pop().c_str());
+    TEST_ASSERT_EQUAL_STRING("u2", pop().c_str());
+    TEST_ASSERT_EQUAL_STRING("n", pop().c_str());
+}
+
+void test_urgent_split_text_keeps_order() {
+    queue->push("normal", 6);
+    std::string txt;
+    for (int i = 0; i < 60; i++) txt += "part" + std::to_string(i / 20) + " ";
+    TalkStream s(queue, nullptr, true);
+    s.feed(reinterpret_cast<const uint8_t*>(txt.data()), txt.size());
+    TEST_ASSERT_TRUE(s.finish());
+    auto first = pop();
+    auto second = pop();
+    TEST_ASSERT_EQUAL(txt.size(), first.size() + second.size());
+    TEST_ASSERT_TRUE(first + second == txt);
+    TEST_ASSERT_EQUAL_STRING("normal", pop().c_str());
+}
+
+/// @brief "@name " is a tag only for a configured zone or "all", otherwise it is text
+void test_unknown_tag_is_text() {
+    ZoneTable zones;
+    TEST_ASSERT_EQUAL(0, zones.load("lobby,1\n", 2));
+    queue->setZones(&zones);
+    Utterance u;
+
+    TEST_ASSERT_TRUE(queue->push("@bob hello", 10));
+    TEST_ASSERT_TRUE(queue->pop(u, 0));
+    TEST_ASSERT_EQUAL_STRING("@bob hello", u.text);
+    TEST_ASSERT_EQUAL(ZoneTable::anyChip, u.chip);
+
+    TEST_ASSERT_TRUE(queue->push("@lobby hi", 9));
+    TEST_ASSERT_FALSE(queue->pop(u, 0));
+    TEST_ASSERT_TRUE(queue->pop(u, 1));
+    TEST_ASSERT_EQUAL_STRING("hi", u.text);
+
+    const char* txt = "@user123 wrote a mail";
+    TalkStream s(queue);
+    s.feed(reinterpret_cast<const uint8_t*>(txt), strlen(txt));
+    TEST_ASSERT_TRUE(s.finish());
+    TEST_ASSERT_TRUE(queue->pop(u, 0));
+    TEST_ASSERT_EQUAL_STRING(txt, u.text);
+}
+
+/// @brief a broadcast counts the chips in service only, a failed chip's copies are removed
+void test_broadcast_ready_chips() {
+    ZoneTable zones;
+    zones.load("", 3);
+    queue->setZones(&zones);
+    Utterance u;
+
+    queue->setReady(1, false);
+    TEST_ASSERT_TRUE(queue->push("@all one", 8));
+    TEST_ASSERT_EQUAL(2, queue->size());
+    TEST_ASSERT_FALSE(queue->pop(u, 1));
+    TEST_ASSERT_TRUE(queue->pop(u, 0));
+    TEST_ASSERT_EQUAL(2, u.copies);
+    TEST_ASSERT_TRUE(queue->pop(u, 2));
+
+    // chip 2 fails after chip 0 took its copy, chip 0 must not wait for it
+    queue->setReady(1, true);
+    uint32_t id = 0;
+    TEST_ASSERT_TRUE(queue->push("@all two", 8, &id));
+    TEST_ASSERT_TRUE(queue->pop(u, 0));
+    TEST_ASSERT_EQUAL(3, u.copies);
+    TEST_ASSERT_EQUAL(id, queue->setReady(2, false));
+    TEST_ASSERT_EQUAL(1, queue->size());
+    TEST_ASSERT_TRUE(queue->pop(u, 1));
+    TEST_ASSERT_EQUAL(2, u.copies);
+
+    // not taken by anyone yet - the remaining copies are consistent, nothing to withdraw
+    TEST_ASSERT_TRUE(queue->push("@all three", 10));
+    TEST_ASSERT_EQUAL(0, queue->setReady(0, false));
+    TEST_ASSERT_TRUE(queue->pop(u, 1));
+    TEST_ASSERT_EQUAL(1, u.copies);
+    TEST_ASSERT_EQUAL(0, queue->size());
+
+    queue->setReady(1, false);
+    TEST_ASSERT_FALSE(queue->push("@all nobody", 11));
+}
+
+/// @brief a chip stopped in the middle of a text releases the rest to the other chips
+void test_failed_chip_releases_text() {
+    host::Task voice[2];
+    for (auto& v : voice) queue->addConsumer(&v);
+    std::string txt;
+    for (int i = 0; i < 150; i++) txt += "part" + std::to_string(i / 50) + " ";
+    TalkStream s(queue);
+    s.feed(reinterpret_cast<const uint8_t*>(txt.data()), txt.size());
+    TEST_ASSERT_TRUE(s.finish());
+    TEST_ASSERT_TRUE(queue->size() >= 3);
+    Utterance u;
+
+    // the parts stay on the chip while it speaks them
+    TEST_ASSERT_TRUE(queue->pop(u, 0));
+    auto group = u.group;
+    std::string spoken(u.text, u.len);
+    TEST_ASSERT_FALSE(queue->pop(u, 1));
+    queue->done(0);
+    TEST_ASSERT_FALSE(queue->pop(u, 1));
+    TEST_ASSERT_TRUE(queue->pop(u, 0));
+    spoken.append(u.text, u.len);
+
+    // chip 0 fails, chip 1 takes the rest
+    queue->setReady(0, false);
+    while (queue->pop(u, 1)) {
+        TEST_ASSERT_EQUAL(group, u.group);
+        spoken.append(u.text, u.len);
+        queue->done(1);
+    }
+    TEST_ASSERT_EQUAL(0, queue->size());
+    TEST_ASSERT_TRUE(spoken == txt);
+
+    // the last part done, a new text goes to any chip
+    queue->setReady(0, true);
+    TEST_ASSERT_TRUE(queue->push("next", 4));
+    TEST_ASSERT_TRUE(queue->pop(u, 0));
+}
+
+/// @brief the zone table rejects the invalid lines
+void test_zone_table_parse() {
+    ZoneTable zones;
+    TEST_ASSERT_EQUAL(0, zones.load("lobby,0,32\r\n\nhall, 1 ,4\nyard,1\n", 2));
+    TEST_ASSERT_EQUAL(3, zones.size());
+    TEST_ASSERT_EQUAL(32, zones.zone(0).relay);
+    TEST_ASSERT_EQUAL(1, zones.zone(1).chip);
+    TEST_ASSERT_EQUAL(-1, zones.zone(2).relay);
+
+    const char* invalid[] = {
+        "lobby", "lobby,", "lobby,x", "lobby,0x1", "lobby,-1", "lobby,2", "lobby,0,",
+        "lobby,0,abc", "lobby,0,6", "lobby,0,11", "lobby,0,34", "lobby,0,39", "lobby,0,40",
+        "lobby,0,-2", "lobby,0,1000", ",0", "all,0", "very_long_zone_name,0",
+    };
+    for (auto line : invalid) {
+        TEST_ASSERT_EQUAL_MESSAGE(1, zones.load(line, 2), line);
+        TEST_ASSERT_EQUAL(0, zones.size());
+    }
+    TEST_ASSERT_EQUAL(2, zones.load("lobby,0\nlobby,1\n", 2));
+    TEST_ASSERT_EQUAL(1, zones.size());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo);
+    RUN_TEST(test_urgent_in_arrival_order);
+    RUN_TEST(test_urgent_wrapped_ring);
+    RUN_TEST(test_urgent_split_text_keeps_order);
+    RUN_TEST(test_unknown_tag_is_text);
+    RUN_TEST(test_broadcast_ready_chips);
+    RUN_TEST(test_failed_chip_releases_text);
+    RUN_TEST(test_zone_table_parse);
+    return UNITY_END();
+}
@@ -0,0 +1,129 @@
+/**
+ * @file test_main.cpp
+ * @author Petr Vanek (petr@fotoventus.cz)
+ * @brief TalkStream - normalization, splitting & streams of several WebSocket clients
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022 Petr Vanek
+ *
+ */
+
+#include <unity.h>
+#include <string>
+#include "talk_stream.h"
+
+static TalkQueue* queue = nullptr;
+
+void setUp() {
+    queue = new TalkQueue();
+}
+
+void tearDown() {
+    delete queue;
+}
+
+static void feed(TalkStream& s, const std::string& txt) {
+    s.feed(reinterpret_cast<const uint8_t*>(txt.data()), txt.size());
+}
+
+static std::string pop() {
+    Utterance u;
+    return queue->pop(u) ? std::string(u.text, u.len) : std::string();
+}
+
+void test_normalization() {
+    TalkStream s(queue);
+    feed(s, "  hello\r\n\tworld  ");
+    TEST_ASSERT_TRUE(s.finish());
+    TEST_ASSERT_EQUAL_STRING("hello world ", pop().c_str());
+}
+
+/// @brief the texts isCollapsed() passes to the queue directly come out of the stream unchanged
+void test_collapsed_fast_path() {
+    const char* texts[] = { "hello", "hello world ", "a", "  ", " ", "", "\t", " hi", "hi  there",
+                            "line\nbreak", "tab\there", "end\r", "@all hi", "x y z" };
+    for (auto t : texts) {
+        TalkStream s(queue);
+        feed(s, t);
+        auto queued = s.finish();
+        auto out = pop();
+        if (TalkStream::isCollapsed(t)) {
+            TEST_ASSERT_TRUE_MESSAGE(queued, t);
+            TEST_ASSERT_EQUAL_STRING_MESSAGE(t, out.c_str(), t);
+        } else {
+            TEST_ASSERT_TRUE_MESSAGE(!queued || out != t, t);     // changed or refused
+        }
+    }
+    // whitespace only is an error on both paths
+    TEST_ASSERT_FALSE(TalkStream::isCollapsed("  "));
+    TalkStream s(queue);
+    feed(s, "  ");
+    TEST_ASSERT_FALSE(s.finish());
+    TEST_ASSERT_EQUAL(0, queue->size());
+}
+
+void test_split_at_word_boundary() {
+    std::string word = "abcdefghi ";
+    std::string txt;
+    while (txt.size() < 1000) txt += word;
+    TalkStream s(queue);
+    feed(s, txt);
+    TEST_ASSERT_TRUE(s.finish());
+
+    std::string joined;
+    size_t parts = 0;
+    for (auto part = pop(); !part.empty(); part = pop(), parts++) {
+        TEST_ASSERT_LESS_OR_EQUAL(S1V30120::maximumMsgSize, part.size());
+        TEST_ASSERT_EQUAL(' ', part.back());
+        joined += part;
+    }
+    TEST_ASSERT_EQUAL(5, parts);
+    TEST_ASSERT_TRUE(joined == txt);
+}
+
+void test_clients_interleaved() {
+    TalkStreamSet<2> set;
+    auto a = set.open(1, queue);
+    auto b = set.open(2, queue);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    feed(*set.find(1), "first ");
+    feed(*set.find(2), "second ");
+    feed(*set.find(1), "client");
+    feed(*set.find(2), "client");
+
+    uint32_t idA = 0, idB = 0;
+    TEST_ASSERT_TRUE(set.close(2, &idB));
+    TEST_ASSERT_TRUE(set.close(1, &idA));
+    TEST_ASSERT_TRUE(idA != idB);
+    TEST_ASSERT_EQUAL_STRING("second client", pop().c_str());
+    TEST_ASSERT_EQUAL_STRING("first client", pop().c_str());
+}
+
+void test_clients_refused_when_full() {
+    TalkStreamSet<2> set;
+    TEST_ASSERT_NOT_NULL(set.open(1, queue));
+    TEST_ASSERT_NOT_NULL(set.open(2, queue));
+    TEST_ASSERT_NULL(set.open(3, queue));
+    TEST_ASSERT_NULL(set.find(3));
+
+    // a new message of the same client replaces its pending one
+    feed(*set.find(1), "pending");
+    TEST_ASSERT_NOT_NULL(set.open(1, queue));
+    TEST_ASSERT_EQUAL_STRING("pending", pop().c_str());
+
+    // a disconnected client frees its slot
+    TEST_ASSERT_FALSE(set.close(2));
+    TEST_ASSERT_NOT_NULL(set.open(3, queue));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_normalization);
+    RUN_TEST(test_collapsed_fast_path);
+    RUN_TEST(test_split_at_word_boundary);
+    RUN_TEST(test_clients_interleaved);
+    RUN_TEST(test_clients_refused_when_full);
+    return UNITY_END();
+}
@@ -0,0 +1,66 @@
+# PlatformIO pre-build script: gzips the web UI from data/ into src/web_assets.h
+# The assets are served from flash as gzip with a strong ETag.
+# The header is rewritten only when its content changes.
+
+import gzip
+import hashlib
+import os
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+    PROJECT_DIR = env["PROJECT_DIR"]  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+ASSETS = [
+    ("talk.html", "talk_html"),
+    ("style.css", "style_css"),
+]
+
+
+def asset_block(path, name):
+    with open(path, "rb") as f:
+        raw = f.read()
+    packed = gzip.compress(raw, compresslevel=9, mtime=0)
+    etag = hashlib.sha1(raw).hexdigest()[:16]
+    lines = ["// %s, %d bytes, gzip %d bytes" % (os.path.basename(path), len(raw), len(packed)),
+             "static const uint8_t %s_gz[] PROGMEM = {" % name]
+    for i in range(0, len(packed), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in packed[i:i + 16]) + ",")
+    lines.append("};")
+    lines.append('static const char %s_etag[] = "\\"%s\\"";' % (name, etag))
+    lines.append("")
+    return "\n".join(lines)
+
+
+def generate():
+    data_dir = os.path.join(PROJECT_DIR, "data")
+    target = os.path.join(PROJECT_DIR, "src", "web_assets.h")
+    body = [
+        "/**",
+        " * @file web_assets.h",
+        " * @brief Web UI gzipped at build time, generated by tools/embed_assets.py from data/",
+        " *",
+        " * Do not edit, the file is overwritten when the data/ sources change.",
+        " */",
+        "",
+        "#pragma once",
+        "#include <inttypes.h>",
+        "#include <pgmspace.h>",
+        "",
+    ]
+    for fname, name in ASSETS:
+        body.append(asset_block(os.path.join(data_dir, fname), name))
+    content = "\n".join(body)
+
+    old = None
+    if os.path.exists(target):
+        with open(target) as f:
+            old = f.read()
+    if old != content:
+        with open(target, "w") as f:
+            f.write(content)
+        print("embed_assets: %s updated" % target)
+
+
+generate()
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""Decoder of the S1V30120 protocol trace (build with -D S1V30120_TRACE).
+
+Input is either the binary dump from http://<device>/trace or a serial log
+containing the "#TRACE <hex>" lines printed after the "#trace" command.
+
+    curl -s http://192.168.2.220/trace | tools/trace_decode.py
+    tools/trace_decode.py serial.log
+"""
+
+import struct
+import sys
+
+KINDS = {1: "send", 2: "response", 3: "upload", 4: "version"}
+
+MESSAGES = {
+    0x0000: "ERROR_IND", 0x0003: "TEST_REQ", 0x0004: "TEST_RESP",
+    0x0005: "VERSION_REQ", 0x0006: "VERSION_RESP", 0x0007: "MSG_BLOCKED_RESP",
+    0x0008: "AUDIO_CONFIG_REQ", 0x0009: "AUDIO_CONFIG_RESP",
+    0x000A: "AUDIO_VOLUME_REQ", 0x000B: "AUDIO_VOLUME_RESP",
+    0x000C: "AUDIO_MUTE_REQ", 0x000D: "AUDIO_MUTE_RESP",
+    0x0012: "TTS_CONFIG_REQ", 0x0013: "TTS_CONFIG_RESP",
+    0x0014: "TTS_SPEAK_REQ", 0x0015: "TTS_SPEAK_RESP",
+    0x0016: "TTS_PAUSE_REQ", 0x0017: "TTS_PAUSE_RESP",
+    0x0018: "TTS_STOP_REQ", 0x0019: "TTS_STOP_RESP",
+    0x0020: "TTS_READY_IND", 0x0021: "TTS_FINISHED_IND",
+    0x1000: "BOOT_LOAD_REQ", 0x1001: "BOOT_LOAD_RESP",
+    0x1002: "BOOT_RUN_REQ", 0x1003: "BOOT_RUN_RESP",
+}
+
+EVENT = struct.Struct("<IIIHHHBB")
+
+
+def load(raw):
+    if raw[:4] == b"ISCT":
+        return raw
+    data = bytearray()
+    for line in raw.decode("ascii", "replace").splitlines():
+        line = line.strip()
+        if line.startswith("#TRACE "):
+            data += bytes.fromhex(line[7:])
+    return bytes(data)
+
+
+def decode(data):
+    if len(data) < 8 or data[:4] != b"ISCT":
+        raise SystemExit("no trace header")
+    version, size, count = data[4], data[5], struct.unpack_from("<H", data, 6)[0]
+    if version != 1 or size != EVENT.size:
+        raise SystemExit("unsupported trace version %d / event size %d" % (version, size))
+
+    print("%12s %4s %-9s %-18s %5s %6s %10s %10s" % ("time[us]", "seq", "kind", "msg", "len", "result", "rdy[us]", "cs[us]"))
+    first = None
+    for i in range(count):
+        off = 8 + i * size
+        if off + size > len(data):
+            break
+        time, rdy, cs, msg, length, result, kind, seq = EVENT.unpack_from(data, off)
+        first = time if first is None else first
+        name = MESSAGES.get(msg, "0x%04X" % msg)
+        print("%12d %4d %-9s %-18s %5d 0x%04X %10d %10d" % (
+            (time - first) & 0xFFFFFFFF, seq, KINDS.get(kind, str(kind)), name, length, result, rdy, cs))
+
+
+def main():
+    if len(sys.argv) > 1:
+        with open(sys.argv[1], "rb") as f:
+            raw = f.read()
+    else:
+        raw = sys.stdin.buffer.read()
+    decode(load(raw))
+
+
+if __name__ == "__main__":
+    main()
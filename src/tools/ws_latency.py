@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""Round trip of the /ws endpoint: every message is sent and timed until the
+ack of the sender ("A <id>"), the start ("S <id>") and the end ("F <id>").
+Standard library only.
+
+    tools/ws_latency.py 192.168.2.220 -n 20
+    tools/ws_latency.py 192.168.2.220 -n 100 --no-wait    # ack latency only
+"""
+
+import argparse
+import base64
+import os
+import socket
+import statistics
+import struct
+import time
+
+
+class WebSocket:
+    """Minimal RFC 6455 client, text frames, masked as required for clients."""
+
+    def __init__(self, host, port, path="/ws", timeout=120.0):
+        self.sock = socket.create_connection((host, port), timeout=timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.sock.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                           "Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\n\r\n" % (path, host, key)).encode())
+        head = b""
+        while b"\r\n\r\n" not in head:
+            chunk = self.sock.recv(1)
+            if not chunk:
+                raise SystemExit("connection closed during the handshake")
+            head += chunk
+        if b" 101 " not in head.split(b"\r\n")[0]:
+            raise SystemExit("handshake failed: %s" % head.split(b"\r\n")[0].decode())
+
+    def send(self, text):
+        data = text.encode()
+        mask = os.urandom(4)
+        if len(data) < 126:
+            head = struct.pack("!BB", 0x81, 0x80 | len(data))
+        else:
+            head = struct.pack("!BBH", 0x81, 0x80 | 126, len(data))
+        self.sock.sendall(head + mask + bytes(b ^ mask[i % 4] for i, b in enumerate(data)))
+
+    def _read(self, n):
+        data = b""
+        while len(data) < n:
+            chunk = self.sock.recv(n - len(data))
+            if not chunk:
+                raise SystemExit("connection closed")
+            data += chunk
+        return data
+
+    def recv(self):
+        """Next text message, control frames are skipped."""
+        while True:
+            b0, b1 = self._read(2)
+            n = b1 & 0x7F
+            if n == 126:
+                n = struct.unpack("!H", self._read(2))[0]
+            elif n == 127:
+                n = struct.unpack("!Q", self._read(8))[0]
+            payload = self._read(n)
+            if b0 & 0x0F == 0x01:
+                return payload.decode("ascii", "replace")
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def report(name, values):
+    if not values:
+        return
+    ms = [v * 1000 for v in values]
+    print("%-8s n=%-4d min=%8.1f  p50=%8.1f  p95=%8.1f  max=%8.1f  mean=%8.1f [ms]"
+          % (name, len(ms), min(ms), percentile(ms, 50), percentile(ms, 95), max(ms), statistics.mean(ms)))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("host")
+    ap.add_argument("--port", type=int, default=80)
+    ap.add_argument("-n", type=int, default=10, help="messages")
+    ap.add_argument("--text", default="test %d")
+    ap.add_argument("--no-wait", action="store_true", help="do not wait for the speech, ack only")
+    args = ap.parse_args()
+
+    ws = WebSocket(args.host, args.port)
+    acks, starts, ends = [], [], []
+    errors = 0
+    for i in range(args.n):
+        sent = time.monotonic()
+        ws.send(args.text % i if "%d" in args.text else args.text)
+        own = None
+        while True:
+            kind, _, value = ws.recv().partition(" ")
+            now = time.monotonic()
+            if own is None and kind in ("A", "E"):
+                own = int(value)
+                acks.append(now - sent)
+                if kind == "E":
+                    errors += 1
+                    break
+                if args.no_wait:
+                    break
+            elif own is not None and int(value) == own:
+                if kind == "S":
+                    starts.append(now - sent)
+                elif kind in ("F", "D"):
+                    ends.append(now - sent)
+                    break
+
+    report("ack", acks)
+    report("start", starts)
+    report("end", ends)
+    if errors:
+        print("rejected %d of %d" % (errors, args.n))
+
+
+if __name__ == "__main__":
+    main()